@@ -0,0 +1,1271 @@
+/// ws2812b_bench
+///
+/// Host benchmark for the ws2812b_data, ws2812b_matrix, ws2812b_lanes,
+/// ws2812b_pool and ws2812b_draw modules, with checks of ws2812b_chunk and
+/// ws2812b_frames
+///
+/// Prints one CSV row per case to stdout:
+/// bench,leds,objects,iterations,ns_per_frame,ns_per_led,fps,checksum
+///
+/// checksum is a hash of the stream after a fixed amount of work, it only
+/// changes if the output changes, so runs from different commits can be
+/// compared for speed and for correctness.  Cases that should send the same
+/// frame as a plain encode of the same input are checked against it, a
+/// mismatch is reported on stderr and the run exits with EXIT_FAILURE.
+///
+/// Usage: ws2812b_bench [min_ms_per_case]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "ws2812b_data.h"
+#include "ws2812b_chunk.h"
+#include "ws2812b_draw.h"
+#include "ws2812b_frames.h"
+#include "ws2812b_matrix.h"
+#include "ws2812b_lanes.h"
+#include "ws2812b_pool.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/// Strip sizes to run
+static size_t const bench_leds[] = {16u, 150u, 1000u, 10000u, 100000u};
+/// Most draw objects in a case
+#define BENCH_OBJECTS_MAX 10000u
+/// Draw object counts to run
+static size_t const bench_objects[] = {1u, 10u, 100u, 1000u, BENCH_OBJECTS_MAX};
+
+/// Frames drawn before the draw checksum is taken
+#define BENCH_CHECK_FRAMES 64u
+/// Milli-seconds passed to every ws2812b_draw call
+#define BENCH_TICK_MS 10
+/// Fewest timed iterations per case
+#define BENCH_MIN_ITERATIONS 3u
+/// LEDs of the reference decode check, the vector kernels' blocks and a tail
+#define BENCH_DECODE_LEDS 67u
+/// Smallest strip the pool cases run on
+#define BENCH_POOL_LEDS_MIN 10000u
+/// Strips the pool many strip cases split the strip into
+#define BENCH_POOL_STRIPS 16u
+/// Frames a 16 bit strip holding 8 bit colors is checked for
+#define BENCH_DITHER_FRAMES 16u
+/// LEDs of the frame rotation check
+#define BENCH_FRAMES_LEDS 150u
+/// Frames published by the frame rotation check
+#define BENCH_FRAMES_PUBLISHED 24u
+/// LEDs per chunk of the chunk check, its ring is 2 chunks (half/complete)
+#define BENCH_CHUNK_LEDS 24u
+
+typedef void (*bench_fn_t)(void);
+
+/// Strip shared by all cases
+static ws2812b_t strip;
+static ws2812b_color_table_t color_table;
+static uint16_t * p_buffer16;
+static uint8_t * p_pixels;
+static ws2812b_matrix_t matrix;
+static size_t * p_matrix_map;
+static ws2812b_matrix_run_t * p_matrix_runs;
+static ws2812b_t lane_strips[WS2812B_LANES_MAX];
+static ws2812b_lanes_t lanes;
+static uint8_t * p_lanes_stream;
+static ws2812b_pool_t pool;
+static ws2812b_t pool_strips[BENCH_POOL_STRIPS];
+static ws2812b_t * p_pool_strips[BENCH_POOL_STRIPS];
+static size_t pool_strip_count;
+static uint8_t * p_dither;
+static uint8_t palette_colors[WS2812B_PALETTE_MAX * WS2812B_BYTES_PER_LED];
+static uint8_t palette_patterns[WS2812B_PALETTE_MAX * WS2812_BYTES_PER_LED_5MHZ];
+static ws2812b_palette_t palette =
+{
+    palette_colors, palette_patterns, sizeof(palette_patterns), WS2812B_PALETTE_MAX, 0u, 8u
+};
+/// Objects shared by the draw cases
+static ws2812b_draw_object_t * p_objects;
+static ws2812b_draw_event_t * p_events;
+static ws2812b_draw_paint_t * p_paints;
+WS2812B_DRAW_SOA_DEFINE(bench_soa, BENCH_OBJECTS_MAX);
+static ws2812b_draw_objects_store_t objects_store;
+/// Seed for the deterministic pseudo random values
+static uint32_t rand_state;
+/// Set when a case's output differs from its reference
+static bool b_bench_failed;
+
+/// Get the monotonic time
+///
+/// @return Time in nano-seconds
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+/// Deterministic pseudo random number (xorshift32)
+///
+/// @return Next number
+static uint32_t bench_rand(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+/// Continue an FNV-1a hash over some bytes
+///
+/// @param hash    The hash so far, 2166136261 to start
+/// @param p_data  The bytes
+/// @param size    The number of bytes
+///
+/// @return The hash
+static uint32_t bench_hash(uint32_t hash, uint8_t const * const p_data, size_t const size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ p_data[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+/// FNV-1a hash of the used part of the stream buffer
+///
+/// @return The hash
+static uint32_t bench_stream_checksum(void)
+{
+    size_t const size = strip.led_count * ws2812b_data_stream_bytes_per_led(&strip);
+
+    return bench_hash(2166136261u, strip.p_stream, size);
+}
+
+/// Fill the storage buffer with a repeatable pattern
+static void bench_fill_buffer(void)
+{
+    rand_state = 0x12345678u;
+
+    for(size_t i = 0; i < strip.buffer_sz; i++)
+    {
+        strip.p_buffer[i] = (uint8_t)bench_rand();
+    }
+}
+
+/// Fill the storage buffer with a mostly dark repeatable pattern
+///
+/// A few lit LEDs every 64, like a handful of small objects on black.
+static void bench_fill_dark(void)
+{
+    rand_state = 0x12345678u;
+    memset(strip.p_buffer, 0, strip.buffer_sz);
+
+    for(size_t led = 0; led < strip.led_count; led += 64u)
+    {
+        size_t const lit = ((strip.led_count - led) < 4u) ? (strip.led_count - led) : 4u;
+
+        ws2812b_data_set_x(&strip, led + 1u, lit,
+                           (uint8_t)bench_rand(), (uint8_t)bench_rand(), (uint8_t)bench_rand());
+    }
+}
+
+/// Set up 16 bit dithering on the strip with a repeatable pattern
+///
+/// @return TRUE on success, FALSE otherwise
+static bool bench_fill_buffer16(size_t const leds)
+{
+    bool b_result;
+
+    strip.p_buffer16 = p_buffer16;
+    strip.buffer16_sz = leds * WS2812B_BYTES_PER_LED * sizeof(uint16_t);
+    strip.p_dither = p_dither;
+    strip.dither_sz = leds * WS2812B_BYTES_PER_LED;
+    b_result = ws2812b_data_init(&strip, WS2812B_INIT_2p5MHz);
+
+    rand_state = 0x12345678u;
+
+    for(size_t led = 1; led <= leds; led++)
+    {
+        uint32_t const color = bench_rand();
+
+        ws2812b_data_set16_x(&strip, led, 1u, (uint16_t)color, (uint16_t)(color >> 16), 0x0123u);
+    }
+
+    return b_result;
+}
+
+/// Color correct the storage buffer the way the color table case encodes it
+///
+/// Each byte goes through the gamma curve and is scaled by its channel's
+/// level at full brightness and by the brightness, rounded.
+///
+/// @param p_max       Levels at full brightness in storage order (GRB)
+/// @param brightness  The brightness
+static void bench_correct_buffer(uint8_t const * const p_max, uint8_t const brightness)
+{
+    for(size_t i = 0; i < strip.buffer_sz; i++)
+    {
+        uint32_t const scale = (uint32_t)p_max[i % WS2812B_BYTES_PER_LED] * brightness;
+
+        strip.p_buffer[i] =
+            (uint8_t)((((uint32_t)ws2812b_gamma_2p2[strip.p_buffer[i]] * scale) + 32512u) / 65025u);
+    }
+}
+
+/// Round the 16 bit buffer into the storage buffer the way the first dither
+/// frame does, the error starts half way
+static void bench_round_buffer16(void)
+{
+    for(size_t i = 0; i < strip.buffer_sz; i++)
+    {
+        uint32_t const sum = (uint32_t)p_buffer16[i] + 0x80u;
+
+        strip.p_buffer[i] = (uint8_t)(((sum > 0xFFFFu) ? 0xFFFFu : sum) >> 8u);
+    }
+}
+
+/// Set the 16 colors of the palette case, through a palette or not
+///
+/// @return TRUE on success, FALSE otherwise
+static bool bench_set_palette_colors(size_t const leds)
+{
+    bool b_result = true;
+
+    rand_state = 0x12345678u;
+
+    for(size_t led = 1; led <= leds; led++)
+    {
+        uint32_t const color = bench_rand() & 0x0Fu;
+
+        b_result = b_result &&
+            ws2812b_data_set(&strip, led, (uint8_t)(color * 16u), (uint8_t)color, 0x40u);
+    }
+
+    return b_result;
+}
+
+/// Set up an 8 bit palette on the strip with 16 colors in a repeatable pattern
+///
+/// @return TRUE on success, FALSE otherwise
+static bool bench_fill_palette(size_t const leds)
+{
+    bool b_result;
+
+    palette.count = 0u;
+    strip.p_palette = &palette;
+    b_result = ws2812b_data_init(&strip, WS2812B_INIT_2p5MHz);
+
+    return b_result && bench_set_palette_colors(leds);
+}
+
+/// Set up the objects with a repeatable mix of solid, blinking and moving
+///
+/// @param count        The number of objects
+/// @param b_soa        Use the dense object arrays
+/// @param active_every Only every active_every'th object blinks or moves
+static void bench_setup_objects(size_t const count, bool const b_soa, size_t const active_every)
+{
+    rand_state = 0x9E3779B9u;
+
+    memset(p_objects, 0, count * sizeof(p_objects[0]));
+    objects_store.p_objects = p_objects;
+    objects_store.object_count = count;
+    objects_store.p_soa = b_soa ? &bench_soa : NULL;
+
+    ws2812b_draw_ctx_init(ws2812b_draw_get_default_ctx());
+    ws2812b_draw_setup(&objects_store, &strip);
+
+    for(size_t idx = 0; idx < count; idx++)
+    {
+        uint32_t const r = (0u == (idx % active_every)) ? bench_rand() : 4u;
+
+        ws2812b_draw_set_action(idx, (0u == (r & 1u)) ? DRAW_ACTION_SOLID :
+                                     (0u == (r & 2u)) ? DRAW_ACTION_BLINK_BLACK :
+                                                        DRAW_ACTION_BLINK_TRANSPARENT);
+        ws2812b_draw_set_blink_rate(idx, BENCH_TICK_MS * (int32_t)(2u + (bench_rand() % 48u)));
+        ws2812b_draw_set_duration(idx, WS2812B_DRAW_FOREVER);
+        ws2812b_draw_set_start_position(idx, 1u);
+        ws2812b_draw_set_end_position(idx, strip.led_count);
+        ws2812b_draw_set_position(idx, 1u + (bench_rand() % strip.led_count));
+        ws2812b_draw_set_length(idx, 1u + (bench_rand() % 8u));
+        ws2812b_draw_set_color(idx,
+                               (uint8_t)bench_rand(),
+                               (uint8_t)bench_rand(),
+                               (uint8_t)bench_rand());
+
+        if(0u == (r & 4u))
+        {
+            ws2812b_draw_set_direction(idx, (0u == (r & 8u)) ? DIRECTION_FORWARD :
+                                                               DIRECTION_REVERSE);
+            ws2812b_draw_set_increment_rate(idx, BENCH_TICK_MS * (1u + (bench_rand() % 9u)));
+            ws2812b_draw_set_reverse(idx, true);
+        }
+        else
+        {
+            ws2812b_draw_set_direction(idx, DIRECTION_NOT_MOVING);
+        }
+    }
+}
+
+static void bench_update_2p5mhz(void)
+{
+    ws2812b_data_mark_dirty_all(&strip);
+    ws2812b_update_stream_2p5mhz(&strip);
+}
+
+static void bench_update_5mhz(void)
+{
+    ws2812b_data_mark_dirty_all(&strip);
+    ws2812b_update_stream_5mhz(&strip);
+}
+
+static void bench_update_uart(void)
+{
+    ws2812b_data_mark_dirty_all(&strip);
+    ws2812b_update_stream_uart(&strip);
+}
+
+static void bench_update_in_place(void)
+{
+    ws2812b_data_mark_dirty_all(&strip);
+    ws2812b_update_stream_2p5mhz(&strip);
+    ws2812b_data_restore(&strip);
+}
+
+static void bench_set_x(void)
+{
+    uint32_t const color = bench_rand();
+
+    ws2812b_data_set_x(&strip, 1u, strip.led_count,
+                       (uint8_t)color, (uint8_t)(color >> 8), (uint8_t)(color >> 16));
+}
+
+static void bench_set_pixels(void)
+{
+    for(size_t led = 0; led < strip.led_count; led++)
+    {
+        uint8_t const * const p_pixel = &p_pixels[led * 3u];
+
+        ws2812b_data_set(&strip, led + 1u, p_pixel[0], p_pixel[1], p_pixel[2]);
+    }
+}
+
+static void bench_blit(void)
+{
+    ws2812b_data_blit(&strip, 1u, strip.led_count, p_pixels, WS2812B_PIXEL_RGB, 0u, false);
+}
+
+static void bench_matrix_set(void)
+{
+    for(size_t y = 0; y < matrix.height; y++)
+    {
+        for(size_t x = 0; x < matrix.width; x++)
+        {
+            uint8_t const * const p_pixel = &p_pixels[((y * matrix.width) + x) * 3u];
+
+            ws2812b_matrix_set(&matrix, x, y, p_pixel[0], p_pixel[1], p_pixel[2]);
+        }
+    }
+}
+
+static void bench_matrix_blit(void)
+{
+    ws2812b_matrix_blit(&matrix, p_pixels, WS2812B_PIXEL_RGB, 0u);
+}
+
+static void bench_lanes_update(void)
+{
+    for(size_t lane = 0; lane < lanes.lane_count; lane++)
+    {
+        ws2812b_data_mark_dirty_all(&lane_strips[lane]);
+    }
+
+    ws2812b_lanes_update(&lanes);
+}
+
+static void bench_pool_update(void)
+{
+    for(size_t idx = 0; idx < pool_strip_count; idx++)
+    {
+        ws2812b_data_mark_dirty_all(p_pool_strips[idx]);
+    }
+
+    ws2812b_pool_update_streams(&pool, p_pool_strips, pool_strip_count);
+}
+
+static void bench_draw(void)
+{
+    ws2812b_draw(BENCH_TICK_MS);
+}
+
+/// Stream formats the reference decoder checks
+typedef struct
+{
+    char const *         p_name;      ///< Format name for errors
+    ws2812b_init_state_t clk;         ///< Stream format
+    uint8_t              symbol_bits; ///< Custom symbols, 0 for the built in formats
+    uint8_t              symbol_0;    ///< Custom symbol for a 0 bit
+    uint8_t              symbol_1;    ///< Custom symbol for a 1 bit
+    uint32_t             slot_ps;     ///< Line time per stream bit (UART bit) in pico-seconds
+} bench_format_t;
+
+static bench_format_t const bench_formats[] =
+{
+    {"2p5mhz", WS2812B_INIT_2p5MHz, 0u, 0u, 0u,             400000u},
+    {"5mhz",   WS2812B_INIT_5MHz,   0u, 0u, 0u,             200000u},
+    {"3p2mhz", WS2812B_INIT_CUSTOM, WS2812B_SYMBOLS_3P2MHZ, 312500u},
+    {"6p4mhz", WS2812B_INIT_CUSTOM, WS2812B_SYMBOLS_6P4MHZ, 156250u},
+    {"uart",   WS2812B_INIT_UART,   0u, 0u, 0u,             400000u},
+};
+
+/// Draw scenes to time
+typedef struct
+{
+    char const *        p_name;       ///< Case name
+    ws2812b_draw_mode_t mode;         ///< Draw mode
+    bool                b_events;     ///< Use an event schedule
+    bool                b_soa;        ///< Use the dense object arrays
+    bool                b_damage;     ///< Only draw the LEDs that change
+    size_t              active_every; ///< Only every active_every'th object blinks or moves
+    size_t              reference;    ///< Case that must draw the same frames, itself for the plain draw
+} bench_draw_case_t;
+
+static bench_draw_case_t const bench_draw_cases[] =
+{
+    {"draw",                    DRAW_MODE_BUFFER, false, false, false, 1u,  0u},
+    {"draw_stream",             DRAW_MODE_STREAM, false, false, false, 1u,  0u},
+    {"draw_events",             DRAW_MODE_BUFFER, true,  false, false, 1u,  0u},
+    {"draw_soa",                DRAW_MODE_BUFFER, false, true,  false, 1u,  0u},
+    {"draw_damage",             DRAW_MODE_BUFFER, false, false, true,  1u,  0u},
+    {"draw_idle",               DRAW_MODE_BUFFER, false, false, false, 64u, 5u},
+    {"draw_idle_events",        DRAW_MODE_BUFFER, true,  false, false, 64u, 5u},
+    {"draw_idle_soa",           DRAW_MODE_BUFFER, false, true,  false, 64u, 5u},
+    {"draw_idle_damage",        DRAW_MODE_BUFFER, false, false, true,  64u, 5u},
+    {"draw_idle_events_damage", DRAW_MODE_BUFFER, true,  true,  true,  64u, 5u},
+};
+
+/// Get the line level of a stream bit
+///
+/// A UART character is sent as 9 bits on an inverted line: a high start
+/// bit, the 7 data bits LSB first inverted and a low stop bit.  SPI bits
+/// are sent MSB first.
+///
+/// @param p_format  The stream format
+/// @param p_stream  The stream
+/// @param slot      The line bit
+///
+/// @return TRUE for high, FALSE for low
+static bool bench_line_level(bench_format_t const * const p_format,
+                             uint8_t const * const p_stream,
+                             size_t const slot)
+{
+    bool b_high;
+
+    if(WS2812B_INIT_UART == p_format->clk)
+    {
+        size_t const bit = slot % 9u;
+
+        b_high = (0u == bit) ||
+                 ((8u != bit) && (0u == ((p_stream[slot / 9u] >> (bit - 1u)) & 1u)));
+    }
+    else
+    {
+        b_high = (0u != ((p_stream[slot / 8u] >> (7u - (slot % 8u))) & 1u));
+    }
+
+    return b_high;
+}
+
+/// Decode a stream from its line timing alone
+///
+/// Every data bit must be a high pulse then a low, both within the WS2812B
+/// data sheet times (T0H 0.4us, T1H 0.8us, T0L 0.85us, T1L 0.45us, all
+/// +-150ns).  The low after the last bit is the reset, it is not checked.
+///
+/// @param p_format    The stream format
+/// @param p_stream    The stream
+/// @param stream_len  The stream size in bytes
+/// @param p_grb       Where to write the decoded bytes
+/// @param grb_len     The number of bytes the stream must hold
+///
+/// @return TRUE if the whole stream decoded, FALSE otherwise
+static bool bench_decode(bench_format_t const * const p_format,
+                         uint8_t const * const p_stream,
+                         size_t const stream_len,
+                         uint8_t * const p_grb,
+                         size_t const grb_len)
+{
+    size_t const slots = stream_len * ((WS2812B_INIT_UART == p_format->clk) ? 9u : 8u);
+    size_t slot = 0u;
+    size_t bits = 0u;
+    bool b_ok = true;
+
+    memset(p_grb, 0, grb_len);
+
+    while(b_ok && (slot < slots) && (bits < (grb_len * 8u)))
+    {
+        uint64_t high_ns = 0u;
+        uint64_t low_ns = 0u;
+
+        for(; (slot < slots) && bench_line_level(p_format, p_stream, slot); slot++)
+        {
+            high_ns += p_format->slot_ps;
+        }
+
+        for(; (slot < slots) && !bench_line_level(p_format, p_stream, slot); slot++)
+        {
+            low_ns += p_format->slot_ps;
+        }
+
+        high_ns /= 1000u;
+        low_ns /= 1000u;
+
+        bool const b_one = (600u < high_ns);
+        bool const b_last = (slot == slots);
+
+        b_ok = b_one ? ((650u <= high_ns) && (950u >= high_ns) &&
+                        (b_last || ((300u <= low_ns) && (600u >= low_ns)))) :
+                       ((250u <= high_ns) && (550u >= high_ns) &&
+                        (b_last || ((700u <= low_ns) && (1000u >= low_ns))));
+
+        p_grb[bits / 8u] |= (uint8_t)((b_one ? 1u : 0u) << (7u - (bits % 8u)));
+        bits++;
+    }
+
+    return b_ok && (bits == (grb_len * 8u)) && (slot == slots);
+}
+
+/// Encode random LEDs in every stream format and decode them back with
+/// bench_decode, a mismatch fails the run
+static void bench_decode_check(void)
+{
+    static uint8_t buffer[BENCH_DECODE_LEDS * WS2812B_BYTES_PER_LED];
+    static uint8_t stream[BENCH_DECODE_LEDS * WS2812B_LED_PATTERN_MAX];
+    static uint8_t decoded[BENCH_DECODE_LEDS * WS2812B_BYTES_PER_LED];
+
+    for(size_t f = 0; f < (sizeof(bench_formats) / sizeof(bench_formats[0])); f++)
+    {
+        bench_format_t const * const p_format = &bench_formats[f];
+        ws2812b_encoder_t encoder;
+        ws2812b_t check = WS2812B_INSTANCE_INIT(buffer, sizeof(buffer), stream, sizeof(stream),
+                                                BENCH_DECODE_LEDS);
+        bool b_ok;
+
+        if(WS2812B_INIT_CUSTOM == p_format->clk)
+        {
+            b_ok = ws2812b_encoder_init(&encoder, p_format->symbol_bits,
+                                        p_format->symbol_0, p_format->symbol_1) &&
+                   ws2812b_data_init_custom(&check, &encoder);
+        }
+        else
+        {
+            b_ok = ws2812b_data_init(&check, p_format->clk);
+        }
+
+        // Random colors after a black and a white LED
+        rand_state = 0x2468ACE1u;
+        ws2812b_data_set(&check, 1u, 0x00u, 0x00u, 0x00u);
+        ws2812b_data_set(&check, 2u, 0xFFu, 0xFFu, 0xFFu);
+
+        for(size_t led = 3; led <= BENCH_DECODE_LEDS; led++)
+        {
+            uint32_t const color = bench_rand();
+
+            ws2812b_data_set(&check, led, (uint8_t)color, (uint8_t)(color >> 8), (uint8_t)(color >> 16));
+        }
+
+        ws2812b_update_stream(&check);
+
+        b_ok = b_ok &&
+               bench_decode(p_format, stream,
+                            BENCH_DECODE_LEDS * ws2812b_data_stream_bytes_per_led(&check),
+                            decoded, sizeof(decoded)) &&
+               (0 == memcmp(decoded, buffer, sizeof(decoded)));
+
+        if(!b_ok)
+        {
+            fprintf(stderr, "decode_%s: stream does not decode to the LED colors\n", p_format->p_name);
+            b_bench_failed = true;
+        }
+    }
+}
+
+/// Check the ws2812b_frames rotation against a plain encode of every frame
+///
+/// The app side changes a few LEDs and publishes a frame every step.  The
+/// transmit side takes a frame every third step and holds it over the next
+/// two, like a slow DMA, so with 2 buffers the app has to re-use the unsent
+/// frame.  With 2 and 3 buffers each taken frame must match the plain
+/// encode of the last published frame and must not change while it is
+/// sent, and the app must never get the buffer being sent.
+static void bench_frames_check(void)
+{
+    static uint8_t buffer[BENCH_FRAMES_LEDS * WS2812B_BYTES_PER_LED];
+    static uint8_t plain_stream[BENCH_FRAMES_LEDS * WS2812_BYTES_PER_LED_2P5MHZ];
+    static uint8_t frame_buffers[WS2812B_FRAMES_MAX][BENCH_FRAMES_LEDS * WS2812_BYTES_PER_LED_2P5MHZ];
+
+    for(size_t frame_count = 2u; frame_count <= WS2812B_FRAMES_MAX; frame_count++)
+    {
+        uint8_t * p_buffers[WS2812B_FRAMES_MAX];
+        ws2812b_frames_t frames;
+        ws2812b_t app = WS2812B_INSTANCE_INIT(buffer, sizeof(buffer),
+                                              frame_buffers[0], sizeof(frame_buffers[0]),
+                                              BENCH_FRAMES_LEDS);
+        ws2812b_t plain = app;
+        uint8_t * p_sending = NULL;
+        uint32_t sending_hash = 0u;
+        bool b_ok;
+
+        for(size_t idx = 0; idx < WS2812B_FRAMES_MAX; idx++)
+        {
+            p_buffers[idx] = frame_buffers[idx];
+        }
+
+        // Both strips encode the same storage
+        memset(buffer, 0, sizeof(buffer));
+        plain.p_stream = plain_stream;
+
+        b_ok = ws2812b_data_init(&app, WS2812B_INIT_2p5MHz) &&
+               ws2812b_data_init(&plain, WS2812B_INIT_2p5MHz) &&
+               ws2812b_frames_init(&frames, &app, p_buffers, frame_count);
+
+        rand_state = 0x13579BDFu;
+
+        for(size_t step = 0; b_ok && (step < BENCH_FRAMES_PUBLISHED); step++)
+        {
+            uint32_t const color = bench_rand();
+            uint32_t published_hash;
+
+            ws2812b_data_set_x(&app, 1u + (color % (BENCH_FRAMES_LEDS - 3u)), 4u,
+                               (uint8_t)(color >> 8), (uint8_t)(color >> 16), (uint8_t)(color >> 24));
+
+            // Only the changed LEDs are encoded into the acquired buffer
+            b_ok = ws2812b_frames_acquire(&frames) && (app.p_stream != p_sending);
+            ws2812b_update_stream_2p5mhz(&app);
+            ws2812b_frames_publish(&frames);
+
+            ws2812b_data_mark_dirty_all(&plain);
+            ws2812b_update_stream_2p5mhz(&plain);
+            published_hash = bench_hash(2166136261u, plain_stream, sizeof(plain_stream));
+
+            if(0u == (step % 3u))
+            {
+                p_sending = ws2812b_frames_take(&frames);
+                sending_hash = published_hash;
+            }
+
+            // The frame being sent is the one taken and stays as it was
+            b_ok = b_ok && (NULL != p_sending) &&
+                   (sending_hash == bench_hash(2166136261u, p_sending, sizeof(plain_stream)));
+
+            if(2u == (step % 3u))
+            {
+                // The write completes
+                ws2812b_frames_release(&frames);
+                p_sending = NULL;
+            }
+        }
+
+        if(!b_ok)
+        {
+            fprintf(stderr, "frames_%zu: the rotation does not match the plain encode\n", frame_count);
+            b_bench_failed = true;
+        }
+    }
+}
+
+/// Check the output of a case against its reference
+///
+/// @param p_name    The case name
+/// @param checksum  Hash of the output of the case
+/// @param expected  Hash of the same input encoded the plain way
+static void bench_check(char const * const p_name,
+                        uint32_t const checksum,
+                        uint32_t const expected)
+{
+    if(checksum != expected)
+    {
+        fprintf(stderr, "%s,%zu: checksum %08lx, expected %08lx\n",
+                p_name, strip.led_count, (unsigned long)checksum, (unsigned long)expected);
+        b_bench_failed = true;
+    }
+}
+
+/// Time a case and print its CSV row
+///
+/// @param p_name    The case name
+/// @param fn        Runs one frame of the case
+/// @param objects   Objects drawn, 0 for data cases
+/// @param checksum  Hash of the output of the case
+/// @param min_ns    Run at least this long
+static void bench_run(char const * const p_name,
+                      bench_fn_t const fn,
+                      size_t const objects,
+                      uint32_t const checksum,
+                      uint64_t const min_ns)
+{
+    uint64_t iterations = 0u;
+    uint64_t const start = bench_now_ns();
+    uint64_t elapsed = 0u;
+
+    // warm up caches and the SIMD kernel selection
+    fn();
+
+    do
+    {
+        fn();
+        iterations++;
+        elapsed = bench_now_ns() - start;
+    }
+    while((elapsed < min_ns) || (iterations < BENCH_MIN_ITERATIONS));
+
+    double const ns_per_frame = (double)elapsed / (double)iterations;
+
+    printf("%s,%zu,%zu,%llu,%.1f,%.3f,%.1f,%08lx\n",
+           p_name,
+           strip.led_count,
+           objects,
+           (unsigned long long)iterations,
+           ns_per_frame,
+           ns_per_frame / (double)strip.led_count,
+           1e9 / ns_per_frame,
+           (unsigned long)checksum);
+    fflush(stdout);
+}
+
+/// Initialize the strip for a size and stream clock
+///
+/// @return TRUE on success, FALSE otherwise
+static bool bench_strip_init(size_t const leds, ws2812b_init_state_t const clk)
+{
+    strip.led_count = leds;
+    strip.buffer_sz = leds * WS2812B_BYTES_PER_LED;
+    strip.stream_sz = leds * WS2812_BYTES_PER_LED_5MHZ;
+
+    return ws2812b_data_init(&strip, clk);
+}
+
+/// Time an in place strip, encode plus restore of every LED
+///
+/// @param leds      The strip size
+/// @param expected  Checksum of the same storage encoded at 2.5Mhz
+/// @param min_ns    Run at least this long
+static void bench_in_place_case(size_t const leds, uint32_t const expected, uint64_t const min_ns)
+{
+    uint8_t * const p_buffer = strip.p_buffer;
+    uint32_t checksum;
+
+    strip.stream_sz = leds * WS2812_BYTES_PER_LED_2P5MHZ;
+    ws2812b_data_init_in_place(&strip, WS2812B_INIT_2p5MHz);
+    bench_fill_buffer();
+    ws2812b_update_stream_2p5mhz(&strip);
+    checksum = bench_stream_checksum();
+    ws2812b_data_restore(&strip);
+    bench_check("update_stream_2p5mhz_in_place", checksum, expected);
+    bench_run("update_stream_2p5mhz_in_place", bench_update_in_place, 0u, checksum, min_ns);
+
+    // Back to separate buffers for the next cases
+    strip.p_buffer = p_buffer;
+}
+
+/// Check a chunked frame of the strip against its stream buffer
+///
+/// Plays a circular DMA over a ring of 2 chunks: the half that was just
+/// sent is hashed up to the end of the frame, must be 0's past it, and is
+/// then refilled by ws2812b_chunk_complete as from the interrupt.
+///
+/// @param leds      The strip size
+/// @param expected  Checksum of the same storage from ws2812b_update_stream
+static void bench_chunk_check(size_t const leds, uint32_t const expected)
+{
+    static uint8_t ring[WS2812B_CHUNK_RING_SZ(BENCH_CHUNK_LEDS, 2u, WS2812_BYTES_PER_LED_2P5MHZ)];
+    size_t const frame_sz = leds * WS2812_BYTES_PER_LED_2P5MHZ;
+    ws2812b_t chunked = strip;
+    ws2812b_chunk_t chunk;
+    ws2812b_chunk_result_t result = WS2812B_CHUNK_ERROR;
+    uint32_t hash = 2166136261u;
+    uint32_t padding = 0u;
+    size_t sent = 0u;
+
+    // Same storage, no stream buffer
+    chunked.p_stream = NULL;
+    chunked.stream_sz = 0u;
+
+    if(ws2812b_data_init(&chunked, WS2812B_INIT_2p5MHz) &&
+       ws2812b_chunk_init(&chunk, &chunked, ring, sizeof(ring), BENCH_CHUNK_LEDS, 2u))
+    {
+        result = WS2812B_CHUNK_BUSY;
+    }
+
+    while(WS2812B_CHUNK_BUSY == result)
+    {
+        uint8_t const * const p_half = &ring[(sent % 2u) * chunk.chunk_sz];
+        size_t const left = frame_sz - (sent * chunk.chunk_sz);
+        size_t const data_sz = (left < chunk.chunk_sz) ? left : chunk.chunk_sz;
+
+        hash = bench_hash(hash, p_half, data_sz);
+
+        for(size_t i = data_sz; i < chunk.chunk_sz; i++)
+        {
+            padding |= p_half[i];
+        }
+
+        sent++;
+        result = ws2812b_chunk_complete(&chunk);
+    }
+
+    bench_check("chunk_2p5mhz", hash, expected);
+    bench_check("chunk_2p5mhz_padding", padding, 0u);
+}
+
+/// Check 8 bit colors set on a 16 bit strip go out as is every frame
+///
+/// The dither carries its error from frame to frame, so a wrong rounding
+/// only shows after the first frame.
+///
+/// @param leds      The strip size
+/// @param expected  Checksum of the same colors encoded without dithering
+static void bench_dither_8bit_check(size_t const leds, uint32_t const expected)
+{
+    strip.p_buffer16 = p_buffer16;
+    strip.buffer16_sz = leds * WS2812B_BYTES_PER_LED * sizeof(uint16_t);
+    strip.p_dither = p_dither;
+    strip.dither_sz = leds * WS2812B_BYTES_PER_LED;
+
+    bench_strip_init(leds, WS2812B_INIT_2p5MHz);
+    bench_fill_buffer();
+
+    // The pattern again through the 8 bit set, which fills the 16 bit buffer
+    for(size_t led = 0; led < leds; led++)
+    {
+        uint8_t const * const p_led = &strip.p_buffer[led * WS2812B_BYTES_PER_LED];
+
+        ws2812b_data_set_x(&strip, led + 1u, 1u, p_led[1], p_led[0], p_led[2]);
+    }
+
+    for(size_t frame = 0; frame < BENCH_DITHER_FRAMES; frame++)
+    {
+        bench_update_2p5mhz();
+        bench_check("update_stream_2p5mhz_dither_8bit", bench_stream_checksum(), expected);
+    }
+
+    strip.p_buffer16 = NULL;
+    bench_strip_init(leds, WS2812B_INIT_2p5MHz);
+}
+
+/// Time a serpentine matrix the size of the strip, set per pixel and blitted
+/// upright (runs) and rotated (map table)
+///
+/// @param leds    The strip size
+/// @param min_ns  Run at least this long
+static void bench_matrix_case(size_t const leds, uint64_t const min_ns)
+{
+    ws2812b_matrix_layout_t layout =
+        {1u, 1u, leds, 1u, 1u, WS2812B_MATRIX_SERPENTINE, WS2812B_MATRIX_PROGRESSIVE, WS2812B_MATRIX_ROTATE_0};
+    uint32_t checksum;
+    uint32_t expected;
+
+    // The most square panel the strip divides into
+    for(size_t width = 1u; (width * width) <= leds; width++)
+    {
+        if(0u == (leds % width))
+        {
+            layout.panel_width = leds / width;
+            layout.panel_height = width;
+        }
+    }
+
+    ws2812b_matrix_init(&matrix, &strip, &layout, p_matrix_map, leds, p_matrix_runs, leds);
+    bench_matrix_set();
+    bench_update_2p5mhz();
+    expected = bench_stream_checksum();
+    bench_run("matrix_set_xy", bench_matrix_set, 0u, expected, min_ns);
+
+    bench_matrix_blit();
+    bench_update_2p5mhz();
+    checksum = bench_stream_checksum();
+    bench_check("matrix_blit", checksum, expected);
+    bench_run("matrix_blit", bench_matrix_blit, 0u, checksum, min_ns);
+
+    // Set per pixel through the rotated map as the reference
+    layout.rotation = WS2812B_MATRIX_ROTATE_90;
+    ws2812b_matrix_init(&matrix, &strip, &layout, p_matrix_map, leds, p_matrix_runs, leds);
+    bench_matrix_set();
+    bench_update_2p5mhz();
+    expected = bench_stream_checksum();
+
+    ws2812b_data_clear_all(&strip);
+    bench_matrix_blit();
+    bench_update_2p5mhz();
+    checksum = bench_stream_checksum();
+    bench_check("matrix_blit_rotated", checksum, expected);
+    bench_run("matrix_blit_rotated", bench_matrix_blit, 0u, checksum, min_ns);
+}
+
+/// Time the strip split into lanes of a 2.5Mhz bit sliced stream
+///
+/// The checksum is of the lanes copied back out one after the other, so it
+/// matches update_stream_2p5mhz when the bit slicing is right.
+///
+/// @param p_name     The case name
+/// @param leds       The strip size
+/// @param lane_count The number of lanes, the first ones get the remainder
+/// @param expected   Checksum of the strip encoded at 2.5Mhz
+/// @param min_ns     Run at least this long
+static void bench_lanes_case(char const * const p_name,
+                             size_t const leds,
+                             size_t const lane_count,
+                             uint32_t const expected,
+                             uint64_t const min_ns)
+{
+    ws2812b_t * p_strips[WS2812B_LANES_MAX];
+    size_t led = 0u;
+
+    for(size_t lane = 0; lane < lane_count; lane++)
+    {
+        size_t const count = (leds / lane_count) + ((lane < (leds % lane_count)) ? 1u : 0u);
+
+        lane_strips[lane].p_buffer = &strip.p_buffer[led * WS2812B_BYTES_PER_LED];
+        lane_strips[lane].buffer_sz = count * WS2812B_BYTES_PER_LED;
+        lane_strips[lane].p_stream = NULL;
+        lane_strips[lane].stream_sz = 0u;
+        lane_strips[lane].led_count = count;
+        ws2812b_data_init(&lane_strips[lane], WS2812B_INIT_2p5MHz);
+        p_strips[lane] = &lane_strips[lane];
+        led += count;
+    }
+
+    ws2812b_lanes_init(&lanes, p_strips, lane_count, p_lanes_stream,
+                       WS2812B_LANES_STREAM_SZ(lane_strips[0].led_count, lane_count, WS2812_BYTES_PER_LED_2P5MHZ));
+    bench_lanes_update();
+    led = 0u;
+
+    for(size_t lane = 0; lane < lane_count; lane++)
+    {
+        ws2812b_lanes_extract(&lanes, lane, &strip.p_stream[led * WS2812_BYTES_PER_LED_2P5MHZ],
+                              strip.stream_sz - (led * WS2812_BYTES_PER_LED_2P5MHZ));
+        led += lane_strips[lane].led_count;
+    }
+
+    bench_check(p_name, bench_stream_checksum(), expected);
+    bench_run(p_name, bench_lanes_update, 0u, bench_stream_checksum(), min_ns);
+}
+
+/// Time the strip encoded by a pool, whole and split into BENCH_POOL_STRIPS
+/// strips, with 0 workers (the caller only) and then 1, 3, 7... workers up
+/// to one per core besides the caller
+///
+/// The split strips share the strip's buffers back to back, so both
+/// streams must match the strip's own update.
+///
+/// @param p_rate    Name of the stream rate for the case names
+/// @param leds      The strip size
+/// @param clk       The stream rate, the strip is initialized for it
+/// @param fn        Updates the strip at clk, for the reference
+/// @param min_ns    Run at least this long
+static void bench_pool_cases(char const * const p_rate,
+                             size_t const leds,
+                             ws2812b_init_state_t const clk,
+                             bench_fn_t const fn,
+                             uint64_t const min_ns)
+{
+    long const cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t const workers_max = (cores > 2) ? ((size_t)cores - 1u) : 1u;
+    size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(&strip);
+    uint32_t expected;
+    size_t workers = 0u;
+    bool b_more = true;
+
+    fn();
+    expected = bench_stream_checksum();
+
+    while(b_more)
+    {
+        char name[64];
+
+        if(!ws2812b_pool_init(&pool, workers, 0u))
+        {
+            b_bench_failed = true;
+            break;
+        }
+
+        // The whole strip, cut into slices
+        memset(strip.p_stream, 0, leds * bytes_per_led);
+        p_pool_strips[0] = &strip;
+        pool_strip_count = 1u;
+        bench_pool_update();
+        snprintf(name, sizeof(name), "pool_update_%s_w%zu", p_rate, workers);
+        bench_check(name, bench_stream_checksum(), expected);
+        bench_run(name, bench_pool_update, 0u, bench_stream_checksum(), min_ns);
+
+        // Many strips, a slice or more each
+        memset(strip.p_stream, 0, leds * bytes_per_led);
+
+        for(size_t idx = 0, led = 0; idx < BENCH_POOL_STRIPS; idx++)
+        {
+            size_t const count = (leds / BENCH_POOL_STRIPS) + ((idx < (leds % BENCH_POOL_STRIPS)) ? 1u : 0u);
+
+            pool_strips[idx].p_buffer = &strip.p_buffer[led * WS2812B_BYTES_PER_LED];
+            pool_strips[idx].buffer_sz = count * WS2812B_BYTES_PER_LED;
+            pool_strips[idx].p_stream = &strip.p_stream[led * bytes_per_led];
+            pool_strips[idx].stream_sz = count * bytes_per_led;
+            pool_strips[idx].led_count = count;
+            ws2812b_data_init(&pool_strips[idx], clk);
+            p_pool_strips[idx] = &pool_strips[idx];
+            led += count;
+        }
+
+        pool_strip_count = BENCH_POOL_STRIPS;
+        bench_pool_update();
+        snprintf(name, sizeof(name), "pool_update_%s_strips_w%zu", p_rate, workers);
+        bench_check(name, bench_stream_checksum(), expected);
+        bench_run(name, bench_pool_update, 0u, bench_stream_checksum(), min_ns);
+
+        ws2812b_pool_deinit(&pool);
+
+        b_more = (workers < workers_max);
+        workers = (((workers * 2u) + 1u) < workers_max) ? ((workers * 2u) + 1u) : workers_max;
+    }
+}
+
+/// Set up, check and time one draw scene
+///
+/// @param p_case  The scene
+/// @param leds    The strip size
+/// @param objects The number of objects
+/// @param min_ns  Run at least this long
+///
+/// @return The checksum of the frame drawn before timing
+static uint32_t bench_draw_case(bench_draw_case_t const * const p_case,
+                                size_t const leds,
+                                size_t const objects,
+                                uint64_t const min_ns)
+{
+    uint32_t checksum;
+
+    bench_strip_init(leds, WS2812B_INIT_2p5MHz);
+    bench_setup_objects(objects, p_case->b_soa, p_case->active_every);
+    ws2812b_draw_set_mode(p_case->mode);
+
+    if(p_case->b_events)
+    {
+        ws2812b_draw_set_events(p_events, objects);
+    }
+
+    if(p_case->b_damage)
+    {
+        ws2812b_draw_set_damage(p_paints, objects);
+    }
+
+    for(size_t frame = 0; frame < BENCH_CHECK_FRAMES; frame++)
+    {
+        bench_draw();
+    }
+
+    if(DRAW_MODE_BUFFER == p_case->mode)
+    {
+        ws2812b_update_stream_2p5mhz(&strip);
+    }
+
+    checksum = bench_stream_checksum();
+    bench_run(p_case->p_name, bench_draw, objects, checksum, min_ns);
+
+    return checksum;
+}
+
+int main(int argc, char ** argv)
+{
+    size_t const max_leds = bench_leds[(sizeof(bench_leds) / sizeof(bench_leds[0])) - 1u];
+    size_t const max_objects = bench_objects[(sizeof(bench_objects) / sizeof(bench_objects[0])) - 1u];
+    uint64_t const min_ns = 1000000u * (uint64_t)((argc > 1) ? strtoul(argv[1], NULL, 10) : 200u);
+    int result = EXIT_FAILURE;
+
+    strip.p_buffer = malloc(max_leds * WS2812B_BYTES_PER_LED);
+    strip.p_stream = malloc(max_leds * WS2812_BYTES_PER_LED_5MHZ);
+    p_objects = malloc(max_objects * sizeof(p_objects[0]));
+    p_events = malloc(max_objects * sizeof(p_events[0]));
+    p_paints = malloc(max_objects * sizeof(p_paints[0]));
+    p_buffer16 = malloc(max_leds * WS2812B_BYTES_PER_LED * sizeof(p_buffer16[0]));
+    p_dither = malloc(max_leds * WS2812B_BYTES_PER_LED);
+    p_pixels = malloc(max_leds * 3u);
+    p_matrix_map = malloc(max_leds * sizeof(p_matrix_map[0]));
+    p_matrix_runs = malloc(max_leds * sizeof(p_matrix_runs[0]));
+    p_lanes_stream = malloc((max_leds + WS2812B_LANES_MAX) * WS2812_BYTES_PER_LED_2P5MHZ);
+
+    if( (NULL != strip.p_buffer) && (NULL != strip.p_stream) &&
+        (NULL != p_objects) && (NULL != p_events) && (NULL != p_paints) &&
+        (NULL != p_buffer16) && (NULL != p_dither) && (NULL != p_pixels) &&
+        (NULL != p_matrix_map) && (NULL != p_matrix_runs) &&
+        (NULL != p_lanes_stream) )
+    {
+        printf("bench,leds,objects,iterations,ns_per_frame,ns_per_led,fps,checksum\n");
+        result = EXIT_SUCCESS;
+        bench_decode_check();
+        bench_frames_check();
+
+        for(size_t l = 0; l < (sizeof(bench_leds) / sizeof(bench_leds[0])); l++)
+        {
+            size_t const leds = bench_leds[l];
+            uint8_t const color_max[WS2812B_BYTES_PER_LED] = {0xE0u, 0xFFu, 0xC0u};
+            uint32_t checksum;
+            uint32_t expected;
+            uint32_t stream_2p5mhz;
+
+            if(!bench_strip_init(leds, WS2812B_INIT_2p5MHz))
+            {
+                result = EXIT_FAILURE;
+                break;
+            }
+            bench_fill_buffer();
+            bench_update_2p5mhz();
+            stream_2p5mhz = bench_stream_checksum();
+            bench_run("update_stream_2p5mhz", bench_update_2p5mhz, 0u, stream_2p5mhz, min_ns);
+            bench_chunk_check(leds, stream_2p5mhz);
+
+            ws2812b_data_color_init(&strip, &color_table, ws2812b_gamma_2p2,
+                                    color_max[1], color_max[0], color_max[2]);
+            ws2812b_data_set_brightness(&strip, 0x80u);
+            bench_update_2p5mhz();
+            checksum = bench_stream_checksum();
+            bench_run("update_stream_2p5mhz_color", bench_update_2p5mhz, 0u, checksum, min_ns);
+            ws2812b_data_color_init(&strip, NULL, NULL, 0u, 0u, 0u);
+            bench_fill_buffer();
+            bench_correct_buffer(color_max, 0x80u);
+            bench_update_2p5mhz();
+            bench_check("update_stream_2p5mhz_color", checksum, bench_stream_checksum());
+
+            if(!bench_fill_buffer16(leds))
+            {
+                result = EXIT_FAILURE;
+                break;
+            }
+            bench_update_2p5mhz();
+            checksum = bench_stream_checksum();
+            bench_run("update_stream_2p5mhz_dither", bench_update_2p5mhz, 0u, checksum, min_ns);
+            strip.p_buffer16 = NULL;
+            bench_strip_init(leds, WS2812B_INIT_2p5MHz);
+            bench_round_buffer16();
+            bench_update_2p5mhz();
+            bench_check("update_stream_2p5mhz_dither", checksum, bench_stream_checksum());
+            bench_dither_8bit_check(leds, stream_2p5mhz);
+
+            if(!bench_fill_palette(leds))
+            {
+                result = EXIT_FAILURE;
+                break;
+            }
+            bench_update_2p5mhz();
+            checksum = bench_stream_checksum();
+            bench_run("update_stream_2p5mhz_palette", bench_update_2p5mhz, 0u, checksum, min_ns);
+            strip.p_palette = NULL;
+            bench_strip_init(leds, WS2812B_INIT_2p5MHz);
+            bench_set_palette_colors(leds);
+            bench_update_2p5mhz();
+            bench_check("update_stream_2p5mhz_palette", checksum, bench_stream_checksum());
+
+            bench_in_place_case(leds, stream_2p5mhz, min_ns);
+
+            bench_strip_init(leds, WS2812B_INIT_2p5MHz);
+            bench_fill_dark();
+            bench_update_2p5mhz();
+            expected = bench_stream_checksum();
+            bench_run("update_stream_2p5mhz_dark", bench_update_2p5mhz, 0u, expected, min_ns);
+
+            strip.b_encode_runs = true;
+            bench_update_2p5mhz();
+            checksum = bench_stream_checksum();
+            bench_check("update_stream_2p5mhz_dark_runs", checksum, expected);
+            bench_run("update_stream_2p5mhz_dark_runs", bench_update_2p5mhz, 0u, checksum, min_ns);
+            strip.b_encode_runs = false;
+
+            bench_strip_init(leds, WS2812B_INIT_5MHz);
+            bench_fill_buffer();
+            bench_update_5mhz();
+            checksum = bench_stream_checksum();
+            bench_run("update_stream_5mhz", bench_update_5mhz, 0u, checksum, min_ns);
+
+            if(BENCH_POOL_LEDS_MIN <= leds)
+            {
+                bench_pool_cases("5mhz", leds, WS2812B_INIT_5MHz, bench_update_5mhz, min_ns);
+
+                bench_strip_init(leds, WS2812B_INIT_2p5MHz);
+                bench_fill_buffer();
+                bench_pool_cases("2p5mhz", leds, WS2812B_INIT_2p5MHz, bench_update_2p5mhz, min_ns);
+            }
+
+            bench_strip_init(leds, WS2812B_INIT_UART);
+            bench_fill_buffer();
+            bench_update_uart();
+            checksum = bench_stream_checksum();
+            bench_run("update_stream_uart", bench_update_uart, 0u, checksum, min_ns);
+
+            bench_strip_init(leds, WS2812B_INIT_2p5MHz);
+            ws2812b_data_set_x(&strip, 1u, leds, 0x12u, 0x34u, 0x56u);
+            bench_update_2p5mhz();
+            checksum = bench_stream_checksum();
+            bench_run("data_set_x", bench_set_x, 0u, checksum, min_ns);
+
+            rand_state = 0x12345678u;
+
+            for(size_t i = 0; i < (leds * 3u); i++)
+            {
+                p_pixels[i] = (uint8_t)bench_rand();
+            }
+
+            bench_set_pixels();
+            bench_update_2p5mhz();
+            expected = bench_stream_checksum();
+            bench_run("data_set_rgb", bench_set_pixels, 0u, expected, min_ns);
+
+            ws2812b_data_clear_all(&strip);
+            bench_blit();
+            bench_update_2p5mhz();
+            checksum = bench_stream_checksum();
+            bench_check("data_blit_rgb", checksum, expected);
+            bench_run("data_blit_rgb", bench_blit, 0u, checksum, min_ns);
+
+            bench_matrix_case(leds, min_ns);
+
+            bench_strip_init(leds, WS2812B_INIT_2p5MHz);
+            bench_fill_buffer();
+            bench_lanes_case("lanes_update_8", leds, 8u, stream_2p5mhz, min_ns);
+            bench_lanes_case("lanes_update_16", leds, 16u, stream_2p5mhz, min_ns);
+
+            for(size_t o = 0; o < (sizeof(bench_objects) / sizeof(bench_objects[0])); o++)
+            {
+                size_t const objects = bench_objects[o];
+                uint32_t draw_checksums[sizeof(bench_draw_cases) / sizeof(bench_draw_cases[0])];
+
+                for(size_t c = 0; c < (sizeof(bench_draw_cases) / sizeof(bench_draw_cases[0])); c++)
+                {
+                    draw_checksums[c] = bench_draw_case(&bench_draw_cases[c], leds, objects, min_ns);
+                    bench_check(bench_draw_cases[c].p_name,
+                                draw_checksums[c],
+                                draw_checksums[bench_draw_cases[c].reference]);
+                }
+            }
+        }
+
+        if(b_bench_failed)
+        {
+            result = EXIT_FAILURE;
+        }
+    }
+
+    free(p_lanes_stream);
+    free(p_matrix_runs);
+    free(p_matrix_map);
+    free(p_pixels);
+    free(p_dither);
+    free(p_buffer16);
+    free(p_paints);
+    free(p_events);
+    free(p_objects);
+    free(strip.p_stream);
+    free(strip.p_buffer);
+
+    return result;
+}
@@ -6,6 +6,10 @@
 #define WS2812B_H_
 
 #include "ws2812b_data.h"
+#include "ws2812b_chunk.h"
+#include "ws2812b_frames.h"
+#include "ws2812b_matrix.h"
+#include "ws2812b_lanes.h"
 #include "ws2812b_draw_common.h"
 #include "ws2812b_draw.h"
 
@@ -0,0 +1,162 @@
+/// ws2812b_chunk
+///
+/// This module streams a ws2812b_data storage buffer out through a small ring
+/// of chunks, refilled from DMA half/complete interrupts, instead of a full
+/// stream buffer
+///
+/// The ring is sent by a circular DMA.  Every time the DMA finishes a chunk
+/// (half transfer or transfer complete for a 2 chunk ring) the app calls
+/// ws2812b_chunk_complete, which encodes the next LEDs into the chunk that
+/// was just sent.  After the last LED the chunks are filled with 0's, which
+/// holds an SPI line low, so stopping the DMA late never corrupts the frame.
+/// A UART can't hold its line low, every character has a start bit, so
+/// UART strips are not supported.
+/// RAM use is fixed by the ring size no matter how long the strip is.
+
+#include "ws2812b_chunk.h"
+
+#include <string.h>
+
+
+static void ws2812b_chunk_fill(ws2812b_chunk_t * const p_chunk);
+
+/// Initialize a chunked stream
+///
+/// The instance does not need a stream buffer, set ws2812b_t::p_stream to
+/// NULL and ws2812b_t::stream_sz to 0 before ws2812b_data_init.  With a 16
+/// bit buffer each chunk is dithered as it is encoded, once per frame.  In
+/// place strips are not supported, their storage lives in the stream, and
+/// neither are UART strips (WS2812B_INIT_UART).
+///
+/// @param p_chunk      The chunked stream to initialize
+/// @param p_instance   The initialized strip to stream
+/// @param p_ring       The ring buffer the DMA sends from
+/// @param ring_sz      The size of p_ring in bytes
+/// @param chunk_leds   The number of LEDs per chunk
+/// @param chunk_count  The number of chunks in the ring, at least 2
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_chunk_init(ws2812b_chunk_t * const p_chunk,
+                        ws2812b_t * const p_instance,
+                        uint8_t * const p_ring,
+                        size_t const ring_sz,
+                        size_t const chunk_leds,
+                        size_t const chunk_count)
+{
+    bool b_result = false;
+
+    if(NULL != p_chunk)
+    {
+        p_chunk->p_instance = NULL;
+
+        size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+
+        if( (NULL != p_ring) &&
+            (0u < bytes_per_led) &&
+            !p_instance->b_in_place &&
+            (WS2812B_INIT_UART != p_instance->init_state) &&
+            (0u < chunk_leds) &&
+            (2u <= chunk_count) &&
+            (WS2812B_CHUNK_RING_SZ(chunk_leds, chunk_count, bytes_per_led) <= ring_sz) )
+        {
+            p_chunk->p_instance = p_instance;
+            p_chunk->p_ring = p_ring;
+            p_chunk->chunk_leds = chunk_leds;
+            p_chunk->chunk_count = chunk_count;
+            p_chunk->chunk_sz = chunk_leds * bytes_per_led;
+
+            b_result = ws2812b_chunk_start_frame(p_chunk);
+        }
+    }
+
+    return b_result;
+}
+
+/// Prime the whole ring with the start of a new frame
+///
+/// Call before (re)starting the DMA on the ring.
+///
+/// @param p_chunk      The chunked stream
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_chunk_start_frame(ws2812b_chunk_t * const p_chunk)
+{
+    bool b_result = false;
+
+    if((NULL != p_chunk) && (NULL != p_chunk->p_instance))
+    {
+        size_t const led_count = p_chunk->p_instance->led_count;
+
+        p_chunk->next_led = 0u;
+        p_chunk->next_chunk = 0u;
+        p_chunk->chunks_sent = 0u;
+        p_chunk->chunks_total =
+            (led_count + p_chunk->chunk_leds - 1u) / p_chunk->chunk_leds;
+
+        for(size_t idx = 0; idx < p_chunk->chunk_count; idx++)
+        {
+            ws2812b_chunk_fill(p_chunk);
+        }
+
+        b_result = true;
+    }
+
+    return b_result;
+}
+
+/// Handle the DMA finishing a chunk, call from the half/complete interrupt
+///
+/// The chunk that was just sent is refilled with the next LEDs of the frame.
+///
+/// @param p_chunk      The chunked stream
+///
+/// @return WS2812B_CHUNK_END_OF_FRAME once every chunk holding LED data has
+///         been sent, WS2812B_CHUNK_BUSY before that
+ws2812b_chunk_result_t ws2812b_chunk_complete(ws2812b_chunk_t * const p_chunk)
+{
+    ws2812b_chunk_result_t result = WS2812B_CHUNK_ERROR;
+
+    if((NULL != p_chunk) && (NULL != p_chunk->p_instance))
+    {
+        if(p_chunk->chunks_sent < p_chunk->chunks_total)
+        {
+            p_chunk->chunks_sent++;
+        }
+
+        ws2812b_chunk_fill(p_chunk);
+
+        result = (p_chunk->chunks_sent >= p_chunk->chunks_total) ?
+            WS2812B_CHUNK_END_OF_FRAME : WS2812B_CHUNK_BUSY;
+    }
+
+    return result;
+}
+
+/// Encode the next LEDs into the next ring slot, 0 padding past the end
+///
+/// @param p_chunk      The chunked stream
+static void ws2812b_chunk_fill(ws2812b_chunk_t * const p_chunk)
+{
+    ws2812b_t * const p_instance = p_chunk->p_instance;
+    uint8_t * const p_dst = &p_chunk->p_ring[p_chunk->next_chunk * p_chunk->chunk_sz];
+
+    size_t const leds_left = p_instance->led_count - p_chunk->next_led;
+    size_t const leds = (leds_left < p_chunk->chunk_leds) ? leds_left : p_chunk->chunk_leds;
+    size_t const used = leds * ws2812b_data_stream_bytes_per_led(p_instance);
+
+    if(0u < leds)
+    {
+        if(NULL != p_instance->p_buffer16)
+        {
+            (void)ws2812b_data_dither(p_instance, p_chunk->next_led + 1u, leds);
+        }
+
+        (void)ws2812b_data_encode(p_instance, p_dst, p_chunk->next_led + 1u, leds);
+        p_chunk->next_led += leds;
+    }
+
+    // Low SPI line after the frame, this is the start of the reset
+    memset(&p_dst[used], 0, p_chunk->chunk_sz - used);
+
+    p_chunk->next_chunk = (p_chunk->next_chunk + 1u) % p_chunk->chunk_count;
+}
@@ -0,0 +1,53 @@
+/// ws2812b_chunk
+///
+/// This module streams a ws2812b_data storage buffer out through a small ring
+/// of chunks, refilled from DMA half/complete interrupts, instead of a full
+/// stream buffer
+
+#ifndef WS2812B_CHUNK_H_
+#define WS2812B_CHUNK_H_
+
+#include "ws2812b_data.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+
+/// Used to help with ring buffer creation, bytes for a ring at a given stream rate
+#define WS2812B_CHUNK_RING_SZ(chunk_leds, chunk_count, bytes_per_led) \
+    ((chunk_leds) * (chunk_count) * (bytes_per_led))
+
+typedef enum
+{
+  WS2812B_CHUNK_BUSY,          ///< Frame data still on its way out, keep the DMA running
+  WS2812B_CHUNK_END_OF_FRAME,  ///< The last LED data has been sent, the DMA can be stopped
+  WS2812B_CHUNK_ERROR,         ///< The chunk stream is not set up
+}ws2812b_chunk_result_t;
+
+/// This struct holds the state of a chunked stream
+typedef struct
+{
+    ws2812b_t * p_instance;     ///< The strip being streamed
+    uint8_t *   p_ring;         ///< Ring of chunk_count chunks handed to the DMA
+    size_t      chunk_leds;     ///< LEDs encoded into each chunk
+    size_t      chunk_count;    ///< The number of chunks in the ring
+    size_t      chunk_sz;       ///< The size of one chunk in bytes
+    size_t      next_led;       ///< Next LED index to encode (0 based)
+    size_t      next_chunk;     ///< Ring slot that is refilled next
+    size_t      chunks_sent;    ///< Chunks completed by the DMA this frame
+    size_t      chunks_total;   ///< Chunks holding LED data this frame
+}
+ws2812b_chunk_t;
+
+
+bool ws2812b_chunk_init(ws2812b_chunk_t * const p_chunk,
+                        ws2812b_t * const p_instance,
+                        uint8_t * const p_ring,
+                        size_t const ring_sz,
+                        size_t const chunk_leds,
+                        size_t const chunk_count);
+bool ws2812b_chunk_start_frame(ws2812b_chunk_t * const p_chunk);
+ws2812b_chunk_result_t ws2812b_chunk_complete(ws2812b_chunk_t * const p_chunk);
+
+#endif /* WS2812B_CHUNK_H_ */
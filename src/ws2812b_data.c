@@ -3,6 +3,346 @@
 /// This module tracks user changes and updates a stream buffer used by SPI
 
 #include "ws2812b_data.h"
+#include "ws2812b_data_simd.h"
+
+#include <string.h>
+
+
+/// Stream bytes generated for every storage byte at 2.5Mhz
+#define WS2812_STREAM_BYTES_PER_BYTE_2P5MHZ (WS2812_BYTES_PER_LED_2P5MHZ / WS2812B_BYTES_PER_LED)
+
+/// Bytes copied per step when repeating a LED pattern over a run
+#define WS2812B_REPLICATE_BLOCK 64u
+
+/// Lookup of a storage byte to its 2.5Mhz stream pattern
+///
+/// Each bit is expanded to 3 bits (1 = 110, 0 = 100) so every byte
+/// expands to exactly 3 stream bytes, MSB first.
+static uint8_t const ws2812b_lut_2p5mhz[256][WS2812_STREAM_BYTES_PER_BYTE_2P5MHZ] =
+{
+    {0x92, 0x49, 0x24}, {0x92, 0x49, 0x26}, {0x92, 0x49, 0x34}, {0x92, 0x49, 0x36}, // 0x00 - 0x03
+    {0x92, 0x49, 0xA4}, {0x92, 0x49, 0xA6}, {0x92, 0x49, 0xB4}, {0x92, 0x49, 0xB6}, // 0x04 - 0x07
+    {0x92, 0x4D, 0x24}, {0x92, 0x4D, 0x26}, {0x92, 0x4D, 0x34}, {0x92, 0x4D, 0x36}, // 0x08 - 0x0B
+    {0x92, 0x4D, 0xA4}, {0x92, 0x4D, 0xA6}, {0x92, 0x4D, 0xB4}, {0x92, 0x4D, 0xB6}, // 0x0C - 0x0F
+    {0x92, 0x69, 0x24}, {0x92, 0x69, 0x26}, {0x92, 0x69, 0x34}, {0x92, 0x69, 0x36}, // 0x10 - 0x13
+    {0x92, 0x69, 0xA4}, {0x92, 0x69, 0xA6}, {0x92, 0x69, 0xB4}, {0x92, 0x69, 0xB6}, // 0x14 - 0x17
+    {0x92, 0x6D, 0x24}, {0x92, 0x6D, 0x26}, {0x92, 0x6D, 0x34}, {0x92, 0x6D, 0x36}, // 0x18 - 0x1B
+    {0x92, 0x6D, 0xA4}, {0x92, 0x6D, 0xA6}, {0x92, 0x6D, 0xB4}, {0x92, 0x6D, 0xB6}, // 0x1C - 0x1F
+    {0x93, 0x49, 0x24}, {0x93, 0x49, 0x26}, {0x93, 0x49, 0x34}, {0x93, 0x49, 0x36}, // 0x20 - 0x23
+    {0x93, 0x49, 0xA4}, {0x93, 0x49, 0xA6}, {0x93, 0x49, 0xB4}, {0x93, 0x49, 0xB6}, // 0x24 - 0x27
+    {0x93, 0x4D, 0x24}, {0x93, 0x4D, 0x26}, {0x93, 0x4D, 0x34}, {0x93, 0x4D, 0x36}, // 0x28 - 0x2B
+    {0x93, 0x4D, 0xA4}, {0x93, 0x4D, 0xA6}, {0x93, 0x4D, 0xB4}, {0x93, 0x4D, 0xB6}, // 0x2C - 0x2F
+    {0x93, 0x69, 0x24}, {0x93, 0x69, 0x26}, {0x93, 0x69, 0x34}, {0x93, 0x69, 0x36}, // 0x30 - 0x33
+    {0x93, 0x69, 0xA4}, {0x93, 0x69, 0xA6}, {0x93, 0x69, 0xB4}, {0x93, 0x69, 0xB6}, // 0x34 - 0x37
+    {0x93, 0x6D, 0x24}, {0x93, 0x6D, 0x26}, {0x93, 0x6D, 0x34}, {0x93, 0x6D, 0x36}, // 0x38 - 0x3B
+    {0x93, 0x6D, 0xA4}, {0x93, 0x6D, 0xA6}, {0x93, 0x6D, 0xB4}, {0x93, 0x6D, 0xB6}, // 0x3C - 0x3F
+    {0x9A, 0x49, 0x24}, {0x9A, 0x49, 0x26}, {0x9A, 0x49, 0x34}, {0x9A, 0x49, 0x36}, // 0x40 - 0x43
+    {0x9A, 0x49, 0xA4}, {0x9A, 0x49, 0xA6}, {0x9A, 0x49, 0xB4}, {0x9A, 0x49, 0xB6}, // 0x44 - 0x47
+    {0x9A, 0x4D, 0x24}, {0x9A, 0x4D, 0x26}, {0x9A, 0x4D, 0x34}, {0x9A, 0x4D, 0x36}, // 0x48 - 0x4B
+    {0x9A, 0x4D, 0xA4}, {0x9A, 0x4D, 0xA6}, {0x9A, 0x4D, 0xB4}, {0x9A, 0x4D, 0xB6}, // 0x4C - 0x4F
+    {0x9A, 0x69, 0x24}, {0x9A, 0x69, 0x26}, {0x9A, 0x69, 0x34}, {0x9A, 0x69, 0x36}, // 0x50 - 0x53
+    {0x9A, 0x69, 0xA4}, {0x9A, 0x69, 0xA6}, {0x9A, 0x69, 0xB4}, {0x9A, 0x69, 0xB6}, // 0x54 - 0x57
+    {0x9A, 0x6D, 0x24}, {0x9A, 0x6D, 0x26}, {0x9A, 0x6D, 0x34}, {0x9A, 0x6D, 0x36}, // 0x58 - 0x5B
+    {0x9A, 0x6D, 0xA4}, {0x9A, 0x6D, 0xA6}, {0x9A, 0x6D, 0xB4}, {0x9A, 0x6D, 0xB6}, // 0x5C - 0x5F
+    {0x9B, 0x49, 0x24}, {0x9B, 0x49, 0x26}, {0x9B, 0x49, 0x34}, {0x9B, 0x49, 0x36}, // 0x60 - 0x63
+    {0x9B, 0x49, 0xA4}, {0x9B, 0x49, 0xA6}, {0x9B, 0x49, 0xB4}, {0x9B, 0x49, 0xB6}, // 0x64 - 0x67
+    {0x9B, 0x4D, 0x24}, {0x9B, 0x4D, 0x26}, {0x9B, 0x4D, 0x34}, {0x9B, 0x4D, 0x36}, // 0x68 - 0x6B
+    {0x9B, 0x4D, 0xA4}, {0x9B, 0x4D, 0xA6}, {0x9B, 0x4D, 0xB4}, {0x9B, 0x4D, 0xB6}, // 0x6C - 0x6F
+    {0x9B, 0x69, 0x24}, {0x9B, 0x69, 0x26}, {0x9B, 0x69, 0x34}, {0x9B, 0x69, 0x36}, // 0x70 - 0x73
+    {0x9B, 0x69, 0xA4}, {0x9B, 0x69, 0xA6}, {0x9B, 0x69, 0xB4}, {0x9B, 0x69, 0xB6}, // 0x74 - 0x77
+    {0x9B, 0x6D, 0x24}, {0x9B, 0x6D, 0x26}, {0x9B, 0x6D, 0x34}, {0x9B, 0x6D, 0x36}, // 0x78 - 0x7B
+    {0x9B, 0x6D, 0xA4}, {0x9B, 0x6D, 0xA6}, {0x9B, 0x6D, 0xB4}, {0x9B, 0x6D, 0xB6}, // 0x7C - 0x7F
+    {0xD2, 0x49, 0x24}, {0xD2, 0x49, 0x26}, {0xD2, 0x49, 0x34}, {0xD2, 0x49, 0x36}, // 0x80 - 0x83
+    {0xD2, 0x49, 0xA4}, {0xD2, 0x49, 0xA6}, {0xD2, 0x49, 0xB4}, {0xD2, 0x49, 0xB6}, // 0x84 - 0x87
+    {0xD2, 0x4D, 0x24}, {0xD2, 0x4D, 0x26}, {0xD2, 0x4D, 0x34}, {0xD2, 0x4D, 0x36}, // 0x88 - 0x8B
+    {0xD2, 0x4D, 0xA4}, {0xD2, 0x4D, 0xA6}, {0xD2, 0x4D, 0xB4}, {0xD2, 0x4D, 0xB6}, // 0x8C - 0x8F
+    {0xD2, 0x69, 0x24}, {0xD2, 0x69, 0x26}, {0xD2, 0x69, 0x34}, {0xD2, 0x69, 0x36}, // 0x90 - 0x93
+    {0xD2, 0x69, 0xA4}, {0xD2, 0x69, 0xA6}, {0xD2, 0x69, 0xB4}, {0xD2, 0x69, 0xB6}, // 0x94 - 0x97
+    {0xD2, 0x6D, 0x24}, {0xD2, 0x6D, 0x26}, {0xD2, 0x6D, 0x34}, {0xD2, 0x6D, 0x36}, // 0x98 - 0x9B
+    {0xD2, 0x6D, 0xA4}, {0xD2, 0x6D, 0xA6}, {0xD2, 0x6D, 0xB4}, {0xD2, 0x6D, 0xB6}, // 0x9C - 0x9F
+    {0xD3, 0x49, 0x24}, {0xD3, 0x49, 0x26}, {0xD3, 0x49, 0x34}, {0xD3, 0x49, 0x36}, // 0xA0 - 0xA3
+    {0xD3, 0x49, 0xA4}, {0xD3, 0x49, 0xA6}, {0xD3, 0x49, 0xB4}, {0xD3, 0x49, 0xB6}, // 0xA4 - 0xA7
+    {0xD3, 0x4D, 0x24}, {0xD3, 0x4D, 0x26}, {0xD3, 0x4D, 0x34}, {0xD3, 0x4D, 0x36}, // 0xA8 - 0xAB
+    {0xD3, 0x4D, 0xA4}, {0xD3, 0x4D, 0xA6}, {0xD3, 0x4D, 0xB4}, {0xD3, 0x4D, 0xB6}, // 0xAC - 0xAF
+    {0xD3, 0x69, 0x24}, {0xD3, 0x69, 0x26}, {0xD3, 0x69, 0x34}, {0xD3, 0x69, 0x36}, // 0xB0 - 0xB3
+    {0xD3, 0x69, 0xA4}, {0xD3, 0x69, 0xA6}, {0xD3, 0x69, 0xB4}, {0xD3, 0x69, 0xB6}, // 0xB4 - 0xB7
+    {0xD3, 0x6D, 0x24}, {0xD3, 0x6D, 0x26}, {0xD3, 0x6D, 0x34}, {0xD3, 0x6D, 0x36}, // 0xB8 - 0xBB
+    {0xD3, 0x6D, 0xA4}, {0xD3, 0x6D, 0xA6}, {0xD3, 0x6D, 0xB4}, {0xD3, 0x6D, 0xB6}, // 0xBC - 0xBF
+    {0xDA, 0x49, 0x24}, {0xDA, 0x49, 0x26}, {0xDA, 0x49, 0x34}, {0xDA, 0x49, 0x36}, // 0xC0 - 0xC3
+    {0xDA, 0x49, 0xA4}, {0xDA, 0x49, 0xA6}, {0xDA, 0x49, 0xB4}, {0xDA, 0x49, 0xB6}, // 0xC4 - 0xC7
+    {0xDA, 0x4D, 0x24}, {0xDA, 0x4D, 0x26}, {0xDA, 0x4D, 0x34}, {0xDA, 0x4D, 0x36}, // 0xC8 - 0xCB
+    {0xDA, 0x4D, 0xA4}, {0xDA, 0x4D, 0xA6}, {0xDA, 0x4D, 0xB4}, {0xDA, 0x4D, 0xB6}, // 0xCC - 0xCF
+    {0xDA, 0x69, 0x24}, {0xDA, 0x69, 0x26}, {0xDA, 0x69, 0x34}, {0xDA, 0x69, 0x36}, // 0xD0 - 0xD3
+    {0xDA, 0x69, 0xA4}, {0xDA, 0x69, 0xA6}, {0xDA, 0x69, 0xB4}, {0xDA, 0x69, 0xB6}, // 0xD4 - 0xD7
+    {0xDA, 0x6D, 0x24}, {0xDA, 0x6D, 0x26}, {0xDA, 0x6D, 0x34}, {0xDA, 0x6D, 0x36}, // 0xD8 - 0xDB
+    {0xDA, 0x6D, 0xA4}, {0xDA, 0x6D, 0xA6}, {0xDA, 0x6D, 0xB4}, {0xDA, 0x6D, 0xB6}, // 0xDC - 0xDF
+    {0xDB, 0x49, 0x24}, {0xDB, 0x49, 0x26}, {0xDB, 0x49, 0x34}, {0xDB, 0x49, 0x36}, // 0xE0 - 0xE3
+    {0xDB, 0x49, 0xA4}, {0xDB, 0x49, 0xA6}, {0xDB, 0x49, 0xB4}, {0xDB, 0x49, 0xB6}, // 0xE4 - 0xE7
+    {0xDB, 0x4D, 0x24}, {0xDB, 0x4D, 0x26}, {0xDB, 0x4D, 0x34}, {0xDB, 0x4D, 0x36}, // 0xE8 - 0xEB
+    {0xDB, 0x4D, 0xA4}, {0xDB, 0x4D, 0xA6}, {0xDB, 0x4D, 0xB4}, {0xDB, 0x4D, 0xB6}, // 0xEC - 0xEF
+    {0xDB, 0x69, 0x24}, {0xDB, 0x69, 0x26}, {0xDB, 0x69, 0x34}, {0xDB, 0x69, 0x36}, // 0xF0 - 0xF3
+    {0xDB, 0x69, 0xA4}, {0xDB, 0x69, 0xA6}, {0xDB, 0x69, 0xB4}, {0xDB, 0x69, 0xB6}, // 0xF4 - 0xF7
+    {0xDB, 0x6D, 0x24}, {0xDB, 0x6D, 0x26}, {0xDB, 0x6D, 0x34}, {0xDB, 0x6D, 0x36}, // 0xF8 - 0xFB
+    {0xDB, 0x6D, 0xA4}, {0xDB, 0x6D, 0xA6}, {0xDB, 0x6D, 0xB4}, {0xDB, 0x6D, 0xB6}, // 0xFC - 0xFF
+};
+
+/// Lookup of a 2.5Mhz stream byte to the storage bits it carries
+///
+/// Indexed by the stream byte's place in its 3 byte pattern.  The 3 lookups
+/// of a pattern OR together to the storage byte.
+static uint8_t const ws2812b_decode_2p5mhz[WS2812_STREAM_BYTES_PER_BYTE_2P5MHZ][256] =
+{
+    {
+        0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60,
+        0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60,
+        0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60,
+        0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60,
+        0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0,
+        0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0,
+        0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0,
+        0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0,
+        0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60,
+        0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60,
+        0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60,
+        0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60,
+        0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0,
+        0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0,
+        0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0,
+        0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0x80, 0xA0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0, 0xC0, 0xE0,
+    },
+    {
+        0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+        0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18, 0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18,
+        0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18, 0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18,
+        0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+        0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18, 0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18,
+        0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18, 0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18,
+        0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+        0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18, 0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18,
+        0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18, 0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18,
+        0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+        0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18, 0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18,
+        0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18, 0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x18,
+    },
+    {
+        0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01,
+        0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03,
+        0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01,
+        0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03,
+        0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01,
+        0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03,
+        0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01,
+        0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03,
+        0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05,
+        0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07,
+        0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05,
+        0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07,
+        0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05,
+        0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07,
+        0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05, 0x04, 0x04, 0x05, 0x05,
+        0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x07, 0x07,
+    },
+};
+
+/// Stream bytes generated for every storage byte at 5Mhz
+#define WS2812_STREAM_BYTES_PER_BYTE_5MHZ (WS2812_BYTES_PER_LED_5MHZ / WS2812B_BYTES_PER_LED)
+
+/// Unaligned 64 and 32 bit stores are cheap and the byte order is known, so
+/// the 5Mhz encoder writes 2 storage bytes (12 stream bytes) in 2 stores.
+/// Elsewhere (e.g. Cortex-M0, no unaligned access) it stores bytes.
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) || defined(__ARM_FEATURE_UNALIGNED))
+#define WS2812B_WORD_STORES
+#endif
+
+/// Lookup of a storage nibble to its 5Mhz stream pattern
+///
+/// Each bit is expanded to 6 bits (1 = 111100, 0 = 110000) so every nibble
+/// expands to exactly 24 stream bits, MSB first.
+static uint32_t const ws2812b_lut_5mhz[16] =
+{
+    0xC30C30u, 0xC30C3Cu, 0xC30F30u, 0xC30F3Cu, // 0x0 - 0x3
+    0xC3CC30u, 0xC3CC3Cu, 0xC3CF30u, 0xC3CF3Cu, // 0x4 - 0x7
+    0xF30C30u, 0xF30C3Cu, 0xF30F30u, 0xF30F3Cu, // 0x8 - 0xB
+    0xF3CC30u, 0xF3CC3Cu, 0xF3CF30u, 0xF3CF3Cu, // 0xC - 0xF
+};
+
+/// Data bits encoded per UART lookup, 2 characters
+#define WS2812_LUT_BITS_UART (2u * WS2812_BITS_PER_CHAR_UART)
+
+/// Lookup of 6 data bits to their 2 UART characters
+///
+/// At 2.5Mbaud 7N1 a character is 9 slots of 400ns, start bit, 7 data
+/// bits LSB first and stop bit.  With TX inverted the start bit is high,
+/// the stop bit and idle line low, so data bits 1 and 4 set and 2 and 5
+/// clear give 3 WS2812 bits as 1x0 1x0 1x0, the 2.5Mhz symbols.  x is the
+/// inverse of data bits 0, 3 and 6, which are cleared for a 1.
+static uint8_t const ws2812b_lut_uart[1u << WS2812_LUT_BITS_UART][2] =
+{
+    {0x5B, 0x5B}, {0x5B, 0x1B}, {0x5B, 0x53}, {0x5B, 0x13}, // 0x00 - 0x03
+    {0x5B, 0x5A}, {0x5B, 0x1A}, {0x5B, 0x52}, {0x5B, 0x12}, // 0x04 - 0x07
+    {0x1B, 0x5B}, {0x1B, 0x1B}, {0x1B, 0x53}, {0x1B, 0x13}, // 0x08 - 0x0B
+    {0x1B, 0x5A}, {0x1B, 0x1A}, {0x1B, 0x52}, {0x1B, 0x12}, // 0x0C - 0x0F
+    {0x53, 0x5B}, {0x53, 0x1B}, {0x53, 0x53}, {0x53, 0x13}, // 0x10 - 0x13
+    {0x53, 0x5A}, {0x53, 0x1A}, {0x53, 0x52}, {0x53, 0x12}, // 0x14 - 0x17
+    {0x13, 0x5B}, {0x13, 0x1B}, {0x13, 0x53}, {0x13, 0x13}, // 0x18 - 0x1B
+    {0x13, 0x5A}, {0x13, 0x1A}, {0x13, 0x52}, {0x13, 0x12}, // 0x1C - 0x1F
+    {0x5A, 0x5B}, {0x5A, 0x1B}, {0x5A, 0x53}, {0x5A, 0x13}, // 0x20 - 0x23
+    {0x5A, 0x5A}, {0x5A, 0x1A}, {0x5A, 0x52}, {0x5A, 0x12}, // 0x24 - 0x27
+    {0x1A, 0x5B}, {0x1A, 0x1B}, {0x1A, 0x53}, {0x1A, 0x13}, // 0x28 - 0x2B
+    {0x1A, 0x5A}, {0x1A, 0x1A}, {0x1A, 0x52}, {0x1A, 0x12}, // 0x2C - 0x2F
+    {0x52, 0x5B}, {0x52, 0x1B}, {0x52, 0x53}, {0x52, 0x13}, // 0x30 - 0x33
+    {0x52, 0x5A}, {0x52, 0x1A}, {0x52, 0x52}, {0x52, 0x12}, // 0x34 - 0x37
+    {0x12, 0x5B}, {0x12, 0x1B}, {0x12, 0x53}, {0x12, 0x13}, // 0x38 - 0x3B
+    {0x12, 0x5A}, {0x12, 0x1A}, {0x12, 0x52}, {0x12, 0x12}, // 0x3C - 0x3F
+};
+
+/// Gamma 2.2 curve, round(255 * (level / 255)^2.2)
+uint8_t const ws2812b_gamma_2p2[256] =
+{
+      0u,   0u,   0u,   0u,   0u,   0u,   0u,   0u,   0u,   0u,   0u,   0u,   0u,   0u,   0u,   1u,
+      1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   1u,   2u,   2u,   2u,   2u,   2u,   2u,   2u,
+      3u,   3u,   3u,   3u,   3u,   4u,   4u,   4u,   4u,   5u,   5u,   5u,   5u,   6u,   6u,   6u,
+      6u,   7u,   7u,   7u,   8u,   8u,   8u,   9u,   9u,   9u,  10u,  10u,  11u,  11u,  11u,  12u,
+     12u,  13u,  13u,  13u,  14u,  14u,  15u,  15u,  16u,  16u,  17u,  17u,  18u,  18u,  19u,  19u,
+     20u,  20u,  21u,  22u,  22u,  23u,  23u,  24u,  25u,  25u,  26u,  26u,  27u,  28u,  28u,  29u,
+     30u,  30u,  31u,  32u,  33u,  33u,  34u,  35u,  35u,  36u,  37u,  38u,  39u,  39u,  40u,  41u,
+     42u,  43u,  43u,  44u,  45u,  46u,  47u,  48u,  49u,  49u,  50u,  51u,  52u,  53u,  54u,  55u,
+     56u,  57u,  58u,  59u,  60u,  61u,  62u,  63u,  64u,  65u,  66u,  67u,  68u,  69u,  70u,  71u,
+     73u,  74u,  75u,  76u,  77u,  78u,  79u,  81u,  82u,  83u,  84u,  85u,  87u,  88u,  89u,  90u,
+     91u,  93u,  94u,  95u,  97u,  98u,  99u, 100u, 102u, 103u, 105u, 106u, 107u, 109u, 110u, 111u,
+    113u, 114u, 116u, 117u, 119u, 120u, 121u, 123u, 124u, 126u, 127u, 129u, 130u, 132u, 133u, 135u,
+    137u, 138u, 140u, 141u, 143u, 145u, 146u, 148u, 149u, 151u, 153u, 154u, 156u, 158u, 159u, 161u,
+    163u, 165u, 166u, 168u, 170u, 172u, 173u, 175u, 177u, 179u, 181u, 182u, 184u, 186u, 188u, 190u,
+    192u, 194u, 196u, 197u, 199u, 201u, 203u, 205u, 207u, 209u, 211u, 213u, 215u, 217u, 219u, 221u,
+    223u, 225u, 227u, 229u, 231u, 234u, 236u, 238u, 240u, 242u, 244u, 246u, 248u, 251u, 253u, 255u,
+};
+
+/// Source offsets of green, red and blue and the pixel size, per ws2812b_pixel_format_t
+static uint8_t const ws2812b_pixel_layout[][4] =
+{
+    {1u, 0u, 2u, 3u},   // WS2812B_PIXEL_RGB
+    {1u, 0u, 2u, 4u},   // WS2812B_PIXEL_RGBA
+    {0u, 1u, 2u, 3u},   // WS2812B_PIXEL_GRB
+    {1u, 2u, 0u, 3u},   // WS2812B_PIXEL_BGR
+    {1u, 2u, 0u, 4u},   // WS2812B_PIXEL_BGRA
+};
+
+/// Masks that gather the deciding bit of every symbol of a storage byte
+///
+/// The deciding bits sit symbol_bits apart.  They are masked and pulled
+/// together in 3 shift and mask steps, pairs, then nibbles, then the byte.
+typedef struct
+{
+    unsigned symbol_bits;               ///< Stream bits per data bit
+    unsigned shift;                     ///< Moves the deciding bits to the symbol LSB
+    uint64_t spread;                    ///< Deciding bits, symbol_bits apart
+    uint64_t pairs;                     ///< Bit pairs after the first step
+    uint64_t nibbles;                   ///< Nibbles after the second step
+}
+ws2812b_decoder_t;
+
+static void ws2812b_encode_2p5mhz(uint8_t * const p_stream,
+                                  uint8_t const * const p_buffer,
+                                  size_t const size);
+static void ws2812b_encode_5mhz(uint8_t * const p_stream,
+                                uint8_t const * const p_buffer,
+                                size_t const size);
+static void ws2812b_encode_uart(ws2812b_color_table_t const * const p_table,
+                                uint8_t * const p_stream,
+                                uint8_t const * const p_buffer,
+                                size_t const size);
+static void ws2812b_add_dirty(ws2812b_t * const p_instance,
+                              size_t start,
+                              size_t end);
+static void ws2812b_add_tx_dirty(ws2812b_t * const p_instance,
+                                 size_t const start,
+                                 size_t const end);
+static void ws2812b_spans_sort(ws2812b_span_t * const p_spans,
+                               size_t const count);
+static void ws2812b_encode_span(ws2812b_t const * const p_instance,
+                                uint8_t * const p_dst,
+                                size_t const led_idx,
+                                size_t const led_cnt);
+static void ws2812b_encode_runs(ws2812b_t const * const p_instance,
+                                uint8_t * const p_dst,
+                                uint8_t const * const p_src,
+                                size_t const led_cnt);
+static size_t ws2812b_run_length(uint8_t const * const p_src,
+                                 size_t const led_cnt);
+static void ws2812b_replicate(uint8_t * const p_dst,
+                              size_t const pattern_sz,
+                              size_t const total);
+static void ws2812b_encode_bytes(ws2812b_t const * const p_instance,
+                                 uint8_t * const p_dst,
+                                 uint8_t const * const p_src,
+                                 size_t const size);
+static void ws2812b_encode_format(ws2812b_t const * const p_instance,
+                                  uint8_t * const p_dst,
+                                  uint8_t const * const p_src,
+                                  size_t const size);
+static void ws2812b_encode_color_table(ws2812b_color_table_t const * const p_table,
+                                       uint8_t * const p_stream,
+                                       uint8_t const * const p_buffer,
+                                       size_t const size,
+                                       size_t const out_bytes);
+static void ws2812b_color_build(ws2812b_t const * const p_instance,
+                                ws2812b_color_table_t * const p_table);
+static void ws2812b_set16(ws2812b_t * const p_instance,
+                          size_t const led_idx,
+                          size_t const led_cnt,
+                          uint16_t const red,
+                          uint16_t const green,
+                          uint16_t const blue);
+static void ws2812b_update_dithered(ws2812b_t * const p_instance,
+                                    size_t const bytes_per_led);
+static void ws2812b_dither(uint16_t const * const p_src,
+                           uint8_t * const p_error,
+                           uint8_t * const p_dst,
+                           size_t const size);
+static bool ws2812b_palette_check(ws2812b_t const * const p_instance,
+                                  size_t const bytes_per_led);
+static void ws2812b_palette_build(ws2812b_t const * const p_instance,
+                                  size_t const first,
+                                  size_t const count);
+static bool ws2812b_palette_find(ws2812b_t * const p_instance,
+                                 uint8_t const red,
+                                 uint8_t const green,
+                                 uint8_t const blue,
+                                 size_t * const p_index);
+static void ws2812b_set_index(ws2812b_t * const p_instance,
+                              size_t const led_idx,
+                              size_t const led_cnt,
+                              size_t const index);
+static void ws2812b_encode_palette(ws2812b_t const * const p_instance,
+                                   uint8_t * const p_dst,
+                                   size_t const led_idx,
+                                   size_t const led_cnt);
+static uint8_t ws2812b_decode_byte(ws2812b_decoder_t const * const p_decoder,
+                                   uint8_t const * const p_stream);
+static void ws2812b_encode_custom(ws2812b_encoder_t const * const p_encoder,
+                                  uint8_t * const p_stream,
+                                  uint8_t const * const p_buffer,
+                                  size_t const size);
+static void ws2812b_blit_grb(uint8_t * const p_dst,
+                             uint8_t const * const p_src,
+                             size_t const count,
+                             uint8_t const * const p_layout,
+                             size_t const step,
+                             bool const b_reverse);
+static size_t ws2812b_blit_palette(ws2812b_t * const p_instance,
+                                   size_t const led_idx,
+                                   size_t const count,
+                                   uint8_t const * const p_src,
+                                   uint8_t const * const p_layout,
+                                   size_t const step,
+                                   bool const b_reverse);
+static size_t ws2812b_bytes_per_led(ws2812b_init_state_t const state,
+                                    ws2812b_encoder_t const * const p_encoder);
 
 
 /// Initialize a ws2812b_t structure
@@ -20,24 +360,69 @@ bool ws2812b_data_init(ws2812b_t * const p_instance,
     if(NULL != p_instance)
     {
         p_instance->init_state = WS2812B_INIT_FAILED;
+        p_instance->b_in_place = false;
+        p_instance->b_encoded = false;
+
+        // A NULL stream with no size is an instance that is only encoded
+        // through ws2812b_data_encode (e.g. by ws2812b_chunk)
+        bool const b_stream_ok = (NULL != p_instance->p_stream) ||
+                                 (0u == p_instance->stream_sz);
 
-        if((NULL != p_instance->p_buffer) && (NULL != p_instance->p_stream))
+        // The shadow is optional too, but is a copy of the stream
+        bool const b_shadow_ok = (NULL == p_instance->p_shadow) ||
+                                 (NULL != p_instance->p_stream);
+
+        if((NULL != p_instance->p_buffer) && b_stream_ok && b_shadow_ok)
         {
             // Verify the buffer size is large enough to account for all LED's
-            bool b_size_check =
-                (p_instance->led_count * WS2812B_BYTES_PER_LED) <= (p_instance->buffer_sz);
+            size_t const buffer_needed = (NULL != p_instance->p_palette) ?
+                WS2812B_PALETTE_BUFFER_SZ(p_instance->led_count, p_instance->p_palette->index_bits) :
+                (p_instance->led_count * WS2812B_BYTES_PER_LED);
+            bool b_size_check = (buffer_needed <= p_instance->buffer_sz);
 
             if(b_size_check)
             {
-                size_t const desired = (WS2812B_INIT_2p5MHz == desired_spi_clk) ?
-                    WS2812_BYTES_PER_LED_2P5MHZ : WS2812_BYTES_PER_LED_5MHZ;
+                size_t const desired =
+                    ws2812b_bytes_per_led(desired_spi_clk, p_instance->p_encoder);
 
-                b_size_check =
-                    (p_instance->led_count * desired) <= (p_instance->stream_sz);
+                b_size_check = (0u < desired) &&
+                    ((NULL == p_instance->p_stream) ||
+                     ((p_instance->led_count * desired) <= (p_instance->stream_sz))) &&
+                    ((NULL == p_instance->p_shadow) ||
+                     ((p_instance->led_count * desired) <= (p_instance->shadow_sz))) &&
+                    ((NULL == p_instance->p_buffer16) ||
+                     (((p_instance->led_count * WS2812B_BYTES_PER_LED * sizeof(uint16_t)) <=
+                       (p_instance->buffer16_sz)) &&
+                      (NULL != p_instance->p_dither) &&
+                      ((p_instance->led_count * WS2812B_BYTES_PER_LED) <= (p_instance->dither_sz)))) &&
+                    ws2812b_palette_check(p_instance, desired);
 
                 p_instance->init_state = b_size_check ?
                     desired_spi_clk : WS2812B_INIT_FAILED;
 
+                // Nothing has been encoded or sent yet
+                ws2812b_data_mark_dirty_all(p_instance);
+                p_instance->tx_len = 0u;
+                p_instance->b_shadow_valid = false;
+
+                // Start every channel half way so the first frame rounds
+                if(b_size_check && (NULL != p_instance->p_buffer16))
+                {
+                    memset(p_instance->p_dither, 0x80,
+                           p_instance->led_count * WS2812B_BYTES_PER_LED);
+                }
+
+                // A color table and palette hold patterns of the format
+                if(b_size_check && (NULL != p_instance->p_color))
+                {
+                    ws2812b_color_build(p_instance, p_instance->p_color);
+                }
+
+                if(b_size_check && (NULL != p_instance->p_palette))
+                {
+                    ws2812b_palette_build(p_instance, 0u, p_instance->p_palette->count);
+                }
+
             }
         }
     }
@@ -45,219 +430,2226 @@ bool ws2812b_data_init(ws2812b_t * const p_instance,
     return (p_instance->init_state != WS2812B_INIT_FAILED);
 }
 
-/// Set values for X LED's the ws2912b_t instance
+/// Initialize a ws2812b_t structure that keeps its storage inside the stream
 ///
-/// @param p_instance      The instance of a ws2912b_t structure (LED string)
-/// @param led_num_start   The LED start position to update (1 based)
-/// @param led_num_to_set  The number of LEDs to update from led_num_start
-/// @param red             The red value
-/// @param green           The blue value
-/// @param blue            The green value
+/// Only ws2812b_t::p_stream (and p_encoder for WS2812B_INIT_CUSTOM) is
+/// needed, p_buffer is pointed at the last led_count * 3 bytes of the
+/// stream, so a strip takes the stream size in RAM and nothing more.
+/// ws2812b_update_stream encodes front to back, each LED's pattern only
+/// overwrites colors already encoded.  The storage buffer is then gone until
+/// ws2812b_data_restore decodes it back from the stream, so:
 ///
-/// @return TRUE on success, FALSE otherwise
-bool ws2812b_data_set_x(ws2812b_t * const p_instance,
-                        size_t const led_num_start,
-                        size_t const led_num_to_set,
-                        uint8_t const red,
-                        uint8_t const green,
-                        uint8_t const blue)
+/// set colors -> ws2812b_update_stream -> send -> ws2812b_data_restore
+///
+/// Until the restore, more ws2812b_update_stream calls leave the encoded
+/// stream as it is, so it can be sent again.
+///
+/// The storage starts out black.  A color table, palette or 16 bit buffer
+/// can't be used, and the stream must be encoded by ws2812b_update_stream.
+///
+/// @param p_instance      pointer to a ws2812b_t instance
+/// @param desired_spi_clk Enum value that selects the stream format
+///
+/// @return TRUE if structure is correct, FALSE otherwise
+bool ws2812b_data_init_in_place(ws2812b_t * const p_instance,
+                                ws2812b_init_state_t const desired_spi_clk)
 {
     bool b_result = false;
 
+    if((NULL != p_instance) &&
+       (NULL != p_instance->p_stream) &&
+       (NULL == p_instance->p_color) &&
+       (NULL == p_instance->p_palette) &&
+       (NULL == p_instance->p_buffer16))
+    {
+        size_t const bytes_per_led =
+            ws2812b_bytes_per_led(desired_spi_clk, p_instance->p_encoder);
+        size_t const used = p_instance->led_count * bytes_per_led;
+        size_t const storage = p_instance->led_count * WS2812B_BYTES_PER_LED;
 
-    if(0 < led_num_start)
+        // A symbol of a single bit would leave no room to grow into
+        if((WS2812B_BYTES_PER_LED < bytes_per_led) && (used <= p_instance->stream_sz))
+        {
+            p_instance->p_buffer = &p_instance->p_stream[used - storage];
+            p_instance->buffer_sz = storage;
+            memset(p_instance->p_buffer, 0, storage);
+
+            b_result = ws2812b_data_init(p_instance, desired_spi_clk);
+            p_instance->b_in_place = b_result;
+        }
+    }
+
+    return b_result;
+}
+
+/// Decode the storage buffer of an in place instance back from its stream
+///
+/// Call after the stream from ws2812b_update_stream has been sent and before
+/// changing any LED.  Decodes back to front, each LED's colors only
+/// overwrite patterns already decoded.  The stream is not valid afterwards.
+/// Does nothing if the storage was not encoded since the last restore.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+///
+/// @return TRUE on success, FALSE if the instance is not in place
+bool ws2812b_data_restore(ws2812b_t * const p_instance)
+{
+    size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+    bool const b_result = (0u < bytes_per_led) && p_instance->b_in_place;
+
+    if(b_result && p_instance->b_encoded)
     {
-        if(p_instance->init_state != WS2812B_INIT_FAILED)
+        unsigned const symbol_bits = (unsigned)(bytes_per_led / WS2812B_BYTES_PER_LED);
+        uint8_t symbol_0 = 0x4u;    // 100 at 2.5Mhz
+        uint8_t symbol_1 = 0x6u;    // 110
+        unsigned decide_bit = 0u;
+        ws2812b_decoder_t decoder = {symbol_bits, 0u, 0u, 0u, 0u};
+
+        if(WS2812B_INIT_5MHz == p_instance->init_state)
         {
-            size_t const led_idx = (led_num_start - 1u);
+            symbol_0 = 0x30u;       // 110000
+            symbol_1 = 0x3Cu;       // 111100
+        }
+        else if(WS2812B_INIT_CUSTOM == p_instance->init_state)
+        {
+            symbol_0 = p_instance->p_encoder->symbol_0;
+            symbol_1 = p_instance->p_encoder->symbol_1;
+        }
 
-            // Verify not beyond bounds
-            if(p_instance->led_count > (led_idx + led_num_to_set - 1u))
+        // The first stream bit of a symbol (MSB first) where 0 and 1 differ
+        while((decide_bit < (symbol_bits - 1u)) &&
+              (0u == (((symbol_0 ^ symbol_1) >> (symbol_bits - 1u - decide_bit)) & 1u)))
+        {
+            decide_bit++;
+        }
+
+        decoder.shift = symbol_bits - 1u - decide_bit;
+
+        for(unsigned bit = 0; bit < 8u; bit++)
+        {
+            decoder.spread |= (uint64_t)1u << (bit * symbol_bits);
+            decoder.pairs |= (uint64_t)((0u == (bit & 1u)) ? 3u : 0u) << (bit * symbol_bits);
+            decoder.nibbles |= (uint64_t)((0u == (bit & 3u)) ? 0xFu : 0u) << (bit * symbol_bits);
+        }
+
+        for(size_t led = p_instance->led_count; led > 0u; led--)
+        {
+            uint8_t const * const p_pattern = &p_instance->p_stream[(led - 1u) * bytes_per_led];
+            uint8_t grb[WS2812B_BYTES_PER_LED];
+
+            // Read the whole LED before its colors overwrite the pattern
+            if(WS2812B_INIT_2p5MHz == p_instance->init_state)
             {
-                size_t const start_idx = (led_idx * WS2812B_BYTES_PER_LED);
+                for(size_t byte = 0; byte < WS2812B_BYTES_PER_LED; byte++)
+                {
+                    uint8_t const * const p_symbols =
+                        &p_pattern[byte * WS2812_STREAM_BYTES_PER_BYTE_2P5MHZ];
 
-                size_t const num_of_bytes =
-                      start_idx + (led_num_to_set * WS2812B_BYTES_PER_LED);
+                    grb[byte] = (uint8_t)(ws2812b_decode_2p5mhz[0][p_symbols[0]] |
+                                          ws2812b_decode_2p5mhz[1][p_symbols[1]] |
+                                          ws2812b_decode_2p5mhz[2][p_symbols[2]]);
+                }
+            }
+            else if(WS2812B_INIT_UART == p_instance->init_state)
+            {
+                uint32_t bits = 0u;
 
-                for(size_t idx = start_idx; idx < num_of_bytes; idx += WS2812B_BYTES_PER_LED)
+                // A data bit is set when its slot (character bit 0, 3 or 6) is clear
+                for(size_t idx = 0; idx < WS2812_BYTES_PER_LED_UART; idx++)
                 {
-                    p_instance->p_buffer[idx]      = green;
-                    p_instance->p_buffer[idx + 1u] = red;
-                    p_instance->p_buffer[idx + 2u] = blue;
+                    uint32_t const slots = ((p_pattern[idx] & 0x01u) << 2u) |
+                                           ((p_pattern[idx] & 0x08u) >> 2u) |
+                                           ((p_pattern[idx] & 0x40u) >> 6u);
+
+                    bits = (bits << WS2812_BITS_PER_CHAR_UART) | (slots ^ 0x7u);
                 }
 
-                b_result = true;
+                grb[0] = (uint8_t)(bits >> 16u);
+                grb[1] = (uint8_t)(bits >> 8u);
+                grb[2] = (uint8_t)bits;
+            }
+            else
+            {
+                for(size_t byte = 0; byte < WS2812B_BYTES_PER_LED; byte++)
+                {
+                    grb[byte] = ws2812b_decode_byte(&decoder, &p_pattern[byte * symbol_bits]);
+                }
             }
+
+            memcpy(&p_instance->p_buffer[(led - 1u) * WS2812B_BYTES_PER_LED],
+                   grb,
+                   WS2812B_BYTES_PER_LED);
         }
+
+        p_instance->b_encoded = false;
     }
+
     return b_result;
 }
 
-/// Set value for a LED in the ws2912b_t instance
+/// Build a custom stream format
 ///
-/// @param p_instance      The instance of a ws2912b_t structure (LED string)
-/// @param led_num         The LED to update (1 based)
-/// @param red             The red value
-/// @param green           The blue value
-/// @param blue            The green value
+/// For SPI clocks other than 2.5Mhz and 5Mhz.  Each data bit is sent as a
+/// symbol of symbol_bits stream bits, MSB first, e.g. WS2812B_SYMBOLS_3P2MHZ.
+/// The nibble lookup is generated here once, so encoding is a table lookup
+/// per nibble at any rate.
+///
+/// @param p_encoder   The encoder to build
+/// @param symbol_bits Stream bits per data bit, 1 to WS2812B_SYMBOL_BITS_MAX
+/// @param symbol_0    Symbol sent for a 0 bit, in the low symbol_bits bits
+/// @param symbol_1    Symbol sent for a 1 bit, in the low symbol_bits bits
 ///
 /// @return TRUE on success, FALSE otherwise
-bool ws2812b_data_set(ws2812b_t * const p_instance,
-                      size_t const led_num,
-                      uint8_t const red,
-                      uint8_t const green,
-                      uint8_t const blue)
+bool ws2812b_encoder_init(ws2812b_encoder_t * const p_encoder,
+                          uint8_t const symbol_bits,
+                          uint8_t const symbol_0,
+                          uint8_t const symbol_1)
 {
-    return ws2812b_data_set_x(p_instance, led_num, 1u, red, green, blue);
+    bool b_result = false;
+
+    if( (NULL != p_encoder) &&
+        (0u < symbol_bits) &&
+        (WS2812B_SYMBOL_BITS_MAX >= symbol_bits) )
+    {
+        uint32_t const mask = (1u << symbol_bits) - 1u;
+
+        if( (symbol_0 <= mask) &&
+            (symbol_1 <= mask) &&
+            (symbol_0 != symbol_1) )
+        {
+            p_encoder->symbol_bits = symbol_bits;
+            p_encoder->symbol_0 = symbol_0;
+            p_encoder->symbol_1 = symbol_1;
+
+            for(uint32_t nibble = 0; nibble < 16u; nibble++)
+            {
+                uint32_t bits = 0u;
+
+                for(int bit = 3; bit >= 0; bit--)
+                {
+                    bits = (bits << symbol_bits) |
+                        (((nibble >> bit) & 1u) ? symbol_1 : symbol_0);
+                }
+
+                p_encoder->lut[nibble] = bits;
+            }
+
+            b_result = true;
+        }
+    }
+
+    return b_result;
 }
 
-/// Set value for all LEDs in the ws2912b_t instance
+/// Initialize a ws2812b_t structure for a custom stream format
 ///
-/// @param p_instance      The instance of a ws2912b_t structure (LED string)
-/// @param red             The red value
-/// @param green           The blue value
-/// @param blue            The green value
+/// Checks the stream buffer against WS2812_BYTES_PER_LED_SYMBOL(symbol_bits)
+/// per LED.  Stream with ws2812b_update_stream.
 ///
-/// @return TRUE on success, FALSE otherwise
-bool ws2812b_data_set_all(ws2812b_t * const p_instance,
-                          uint8_t const red,
-                          uint8_t const green,
-                          uint8_t const blue)
+/// @param p_instance pointer to a ws2812b_t instance
+/// @param p_encoder  Encoder from ws2812b_encoder_init, must stay valid
+///
+/// @return TRUE if structure is correct, FALSE otherwise
+bool ws2812b_data_init_custom(ws2812b_t * const p_instance,
+                              ws2812b_encoder_t const * const p_encoder)
 {
-    return ws2812b_data_set_x(p_instance, 1u, p_instance->led_count, red, green, blue);
+    bool b_result = false;
+
+    if((NULL != p_instance) && (NULL != p_encoder))
+    {
+        p_instance->p_encoder = p_encoder;
+        b_result = ws2812b_data_init(p_instance, WS2812B_INIT_CUSTOM);
+    }
+
+    return b_result;
 }
 
-/// Clear (0's) values for all LEDs in the ws2912b_t instance
+/// Turn on color correction for an instance
+///
+/// Call after the instance is initialized, the table holds stream patterns
+/// of the instance's format.  Starts at full brightness.  The correction
+/// is applied while encoding, the storage buffer keeps the colors as set.
+/// A table can only be used by one instance.
 ///
 /// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param p_table         App storage for the table, NULL turns correction off
+/// @param p_gamma         256 entry curve, NULL for linear (e.g. ws2812b_gamma_2p2)
+/// @param red_max         Red level at full brightness (white balance)
+/// @param green_max       Green level at full brightness (white balance)
+/// @param blue_max        Blue level at full brightness (white balance)
 ///
 /// @return TRUE on success, FALSE otherwise
-bool ws2812b_data_clear_all(ws2812b_t * const p_instance)
+bool ws2812b_data_color_init(ws2812b_t * const p_instance,
+                             ws2812b_color_table_t * const p_table,
+                             uint8_t const * const p_gamma,
+                             uint8_t const red_max,
+                             uint8_t const green_max,
+                             uint8_t const blue_max)
 {
-    return ws2812b_data_set_all(p_instance, 0u, 0u, 0u);
-}
+    bool b_result = false;
+
+    // Colors decoded by ws2812b_data_restore would come back corrected
+    if((0u < ws2812b_data_stream_bytes_per_led(p_instance)) &&
+       !((NULL != p_table) && p_instance->b_in_place))
+    {
+        if(NULL != p_table)
+        {
+            p_table->p_gamma = p_gamma;
+            p_table->red_max = red_max;
+            p_table->green_max = green_max;
+            p_table->blue_max = blue_max;
+            p_table->brightness = UINT8_MAX;
+            ws2812b_color_build(p_instance, p_table);
+        }
 
+        p_instance->p_color = p_table;
 
-/// Populate 2.5Mhz stream buffer with storage buffer
-///
-/// Every 1 bit is converted to a stream of  3 bits
-/// So a 1 bit will be 110 and a 0 bit will be 100
+        // Every LED encodes differently now
+        if(NULL != p_instance->p_palette)
+        {
+            ws2812b_palette_build(p_instance, 0u, p_instance->p_palette->count);
+        }
+
+        ws2812b_data_mark_dirty_all(p_instance);
+        b_result = true;
+    }
+
+    return b_result;
+}
+
+/// Change the brightness of an instance with color correction
 ///
-/// @note that the reset is not part of the stream
-/// It is up to the application to delay before sending another stream
+/// Rebuilds the table, the next stream update re-encodes every LED.
 ///
 /// @param p_instance      The instance of a ws2912b_t structure (LED string)
-void ws2812b_update_stream_2p5mhz(ws2812b_t * const p_instance)
+/// @param brightness      0 (off) to 255 (full)
+///
+/// @return TRUE on success, FALSE if there is no color table
+bool ws2812b_data_set_brightness(ws2812b_t * const p_instance,
+                                 uint8_t const brightness)
 {
-    if(p_instance->init_state == WS2812B_INIT_2p5MHz)
-    {
-        // Loop through each byte
-        size_t const buffer_size = p_instance->buffer_sz;
-        //size_t const stream_size = p_instance->stream_sz;
-        uint8_t const * const p_buffer = p_instance->p_buffer;
-        uint8_t * const p_stream = p_instance->p_stream;
-
-        size_t stream_index = 0;
-        uint8_t current_byte = 0;
-        int bit_in_byte = 0; // Tracks the bit position in the current byte of p_stream
+    bool b_result = false;
 
-        for (size_t i = 0; i < buffer_size; i++)
+    if((0u < ws2812b_data_stream_bytes_per_led(p_instance)) &&
+       (NULL != p_instance->p_color))
+    {
+        if(brightness != p_instance->p_color->brightness)
         {
-            for (int bit = 7; bit >= 0; bit--)
+            p_instance->p_color->brightness = brightness;
+            ws2812b_color_build(p_instance, p_instance->p_color);
+
+            if(NULL != p_instance->p_palette)
             {
-                uint8_t original_bit = (p_buffer[i] >> bit) & 1;
+                ws2812b_palette_build(p_instance, 0u, p_instance->p_palette->count);
+            }
 
-                // For each bit in the original byte, we will add 3 bits to p_stream
-                uint8_t bits_to_add[6] = {1, 1, 0, 1, 0, 0};
+            ws2812b_data_mark_dirty_all(p_instance);
+        }
 
-                for (int j = 0; j < 3; j++)
-                {
-                    int k = (original_bit == 1) ? j : (j + 3);
-                    current_byte = (current_byte << 1) | bits_to_add[k];
-                    bit_in_byte++;
+        b_result = true;
+    }
 
-                    if (bit_in_byte == 8)
-                    {
-                        // Just as a safety check, don't go beyond the stream size
-                        //if(stream_index < stream_size)
-                        {
-                            // If the current byte is full, move to the next byte in p_stream
-                            p_stream[stream_index++] = current_byte;
-                            current_byte = 0;
-                            bit_in_byte = 0;
-                        }
-                    }
-                }
-            }
-        }
+    return b_result;
+}
+
+/// Set a palette color of an instance that stores palette indices
+///
+/// Every LED showing the entry changes color with the next stream update.
+/// Entries past the ones in use are added (the ones skipped are black).
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param index           The palette entry, less than ws2812b_palette_t::size
+/// @param red             The red value
+/// @param green           The green value
+/// @param blue            The blue value
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_palette_set(ws2812b_t * const p_instance,
+                              size_t const index,
+                              uint8_t const red,
+                              uint8_t const green,
+                              uint8_t const blue)
+{
+    bool b_result = false;
 
-        // Handle the last byte if it's not full
-        if (bit_in_byte != 0)
+    if((0u < ws2812b_data_stream_bytes_per_led(p_instance)) &&
+       (NULL != p_instance->p_palette) &&
+       (index < p_instance->p_palette->size))
+    {
+        ws2812b_palette_t * const p_palette = p_instance->p_palette;
+        size_t const first = (index < p_palette->count) ? index : p_palette->count;
+
+        if(p_palette->count <= index)
+        {
+            memset(&p_palette->p_colors[p_palette->count * WS2812B_BYTES_PER_LED], 0,
+                   (index - p_palette->count) * WS2812B_BYTES_PER_LED);
+            p_palette->count = index + 1u;
+        }
+        else
         {
-            current_byte <<= (8 - bit_in_byte); // Shift to align to the most significant bit
-            p_stream[stream_index] = current_byte;
+            // LEDs using the entry are not tracked, encode them all
+            ws2812b_data_mark_dirty_all(p_instance);
         }
+
+        p_palette->p_colors[(index * WS2812B_BYTES_PER_LED)]      = green;
+        p_palette->p_colors[(index * WS2812B_BYTES_PER_LED) + 1u] = red;
+        p_palette->p_colors[(index * WS2812B_BYTES_PER_LED) + 2u] = blue;
+        ws2812b_palette_build(p_instance, first, (index + 1u) - first);
+        b_result = true;
     }
+
+    return b_result;
 }
 
-/// Populate 5Mhz stream buffer with storage buffer
-///
-/// Every 1 bit is converted to a stream of  6 bits
-/// So a 1 bit will be 111100 and a 0 bit will be 110000
-///
-/// @note that the reset is not part of the stream
-/// It is up to the application to delay before sending another stream
+/// Set X LED's of an instance that stores palette indices to a palette entry
 ///
 /// @param p_instance      The instance of a ws2912b_t structure (LED string)
-void ws2812b_update_stream_5mhz(ws2812b_t * const p_instance)
+/// @param led_num_start   The LED start position to update (1 based)
+/// @param led_num_to_set  The number of LEDs to update from led_num_start
+/// @param index           The palette entry, one that is in use
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_set_index_x(ws2812b_t * const p_instance,
+                              size_t const led_num_start,
+                              size_t const led_num_to_set,
+                              size_t const index)
 {
-    if(p_instance->init_state == WS2812B_INIT_5MHz)
-    {
-        // Loop through each byte
-        size_t const buffer_size = p_instance->buffer_sz;
-        //size_t const stream_size = p_instance->stream_sz;
-        uint8_t const * const p_buffer = p_instance->p_buffer;
-        uint8_t * const p_stream = p_instance->p_stream;
+    bool b_result = false;
 
-        size_t stream_index = 0;
-        uint8_t current_byte = 0;
-        int bit_in_byte = 0; // Tracks the bit position in the current byte of p_stream
+    if((0u < led_num_start) &&
+       (p_instance->init_state != WS2812B_INIT_FAILED) &&
+       (NULL != p_instance->p_palette) &&
+       (index < p_instance->p_palette->count))
+    {
+        size_t const led_idx = (led_num_start - 1u);
 
-        for (size_t i = 0; i < buffer_size; i++)
+        // Verify not beyond bounds
+        if((led_idx <= p_instance->led_count) &&
+           (led_num_to_set <= (p_instance->led_count - led_idx)))
         {
-            for (int bit = 7; bit >= 0; bit--)
-            {
-                uint8_t original_bit = (p_buffer[i] >> bit) & 1;
+            ws2812b_set_index(p_instance, led_idx, led_num_to_set, index);
+            ws2812b_add_dirty(p_instance, led_idx, led_idx + led_num_to_set);
+            b_result = true;
+        }
+    }
 
-                // For each bit in the original byte, we will add 6 bits to p_stream
-                uint8_t bits_to_add[12] = {1, 1, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0};
+    return b_result;
+}
 
-                for (int j = 0; j < 6; j++)
-                {
-                    int k = (original_bit == 1) ? j : (j + 6);
-                    current_byte = (current_byte << 1) | bits_to_add[k];
-                    bit_in_byte++;
+/// Set 16 bit values for X LED's of an instance with a 16 bit buffer
+///
+/// Each ws2812b_update_stream... dithers the 16 bit colors to 8 bits, the
+/// rounding error of a LED is carried to its next frame so over a few
+/// frames the LED shows the 16 bit level on average.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_num_start   The LED start position to update (1 based)
+/// @param led_num_to_set  The number of LEDs to update from led_num_start
+/// @param red             The red value, 0xFFFF is full
+/// @param green           The green value, 0xFFFF is full
+/// @param blue            The blue value, 0xFFFF is full
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_set16_x(ws2812b_t * const p_instance,
+                          size_t const led_num_start,
+                          size_t const led_num_to_set,
+                          uint16_t const red,
+                          uint16_t const green,
+                          uint16_t const blue)
+{
+    bool b_result = false;
 
-                    if (bit_in_byte == 8)
-                    {
-                        // Just as a safety check, don't go beyond the stream size
-                        //if(stream_index < stream_size)
-                        {
-                            // If the current byte is full, move to the next byte in p_stream
-                            p_stream[stream_index++] = current_byte;
-                            current_byte = 0;
-                            bit_in_byte = 0;
-                        }
-                    }
-                }
-            }
-        }
+    if((0u < led_num_start) &&
+       (p_instance->init_state != WS2812B_INIT_FAILED) &&
+       (NULL != p_instance->p_buffer16))
+    {
+        size_t const led_idx = (led_num_start - 1u);
 
-        // Handle the last byte if it's not full
-        if (bit_in_byte != 0)
+        // Verify not beyond bounds
+        if((led_idx <= p_instance->led_count) &&
+           (led_num_to_set <= (p_instance->led_count - led_idx)))
         {
-            current_byte <<= (8 - bit_in_byte); // Shift to align to the most significant bit
-            p_stream[stream_index] = current_byte;
+            ws2812b_set16(p_instance, led_idx, led_num_to_set, red, green, blue);
+            ws2812b_add_dirty(p_instance, led_idx, led_idx + led_num_to_set);
+            b_result = true;
         }
     }
+
+    return b_result;
+}
+
+/// Set values for X LED's the ws2912b_t instance
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_num_start   The LED start position to update (1 based)
+/// @param led_num_to_set  The number of LEDs to update from led_num_start
+/// @param red             The red value
+/// @param green           The blue value
+/// @param blue            The green value
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_set_x(ws2812b_t * const p_instance,
+                        size_t const led_num_start,
+                        size_t const led_num_to_set,
+                        uint8_t const red,
+                        uint8_t const green,
+                        uint8_t const blue)
+{
+    bool b_result = false;
+
+
+    if(0 < led_num_start)
+    {
+        if(p_instance->init_state != WS2812B_INIT_FAILED)
+        {
+            size_t const led_idx = (led_num_start - 1u);
+
+            // Verify not beyond bounds
+            if(p_instance->led_count > (led_idx + led_num_to_set - 1u))
+            {
+                size_t const start_idx = (led_idx * WS2812B_BYTES_PER_LED);
+
+                size_t const num_of_bytes =
+                      start_idx + (led_num_to_set * WS2812B_BYTES_PER_LED);
+
+                size_t index;
+
+                if(NULL != p_instance->p_palette)
+                {
+                    // Fails when the color is new and the palette is full
+                    b_result = ws2812b_palette_find(p_instance, red, green, blue, &index);
+
+                    if(b_result)
+                    {
+                        ws2812b_set_index(p_instance, led_idx, led_num_to_set, index);
+                    }
+                }
+                else
+                {
+                    for(size_t idx = start_idx; idx < num_of_bytes; idx += WS2812B_BYTES_PER_LED)
+                    {
+                        p_instance->p_buffer[idx]      = green;
+                        p_instance->p_buffer[idx + 1u] = red;
+                        p_instance->p_buffer[idx + 2u] = blue;
+                    }
+
+                    b_result = true;
+                }
+
+                if(NULL != p_instance->p_buffer16)
+                {
+                    // An empty low byte leaves less than 1 to carry, so the
+                    // dither always gives back the 8 bit color
+                    ws2812b_set16(p_instance, led_idx, led_num_to_set,
+                                  (uint16_t)(red << 8u),
+                                  (uint16_t)(green << 8u),
+                                  (uint16_t)(blue << 8u));
+                }
+
+                if(b_result)
+                {
+                    ws2812b_add_dirty(p_instance, led_idx, led_idx + led_num_to_set);
+                }
+            }
+        }
+    }
+    return b_result;
+}
+
+/// Set value for a LED in the ws2912b_t instance
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_num         The LED to update (1 based)
+/// @param red             The red value
+/// @param green           The blue value
+/// @param blue            The green value
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_set(ws2812b_t * const p_instance,
+                      size_t const led_num,
+                      uint8_t const red,
+                      uint8_t const green,
+                      uint8_t const blue)
+{
+    return ws2812b_data_set_x(p_instance, led_num, 1u, red, green, blue);
+}
+
+/// Set value for all LEDs in the ws2912b_t instance
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param red             The red value
+/// @param green           The blue value
+/// @param blue            The green value
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_set_all(ws2812b_t * const p_instance,
+                          uint8_t const red,
+                          uint8_t const green,
+                          uint8_t const blue)
+{
+    return ws2812b_data_set_x(p_instance, 1u, p_instance->led_count, red, green, blue);
+}
+
+/// Clear (0's) values for all LEDs in the ws2912b_t instance
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_clear_all(ws2812b_t * const p_instance)
+{
+    return ws2812b_data_set_all(p_instance, 0u, 0u, 0u);
+}
+
+/// Copy an array of pixels into a range of LEDs
+///
+/// Checks the instance and range once and converts the whole array to the
+/// storage order in one pass (vectorized for packed pixels), where a
+/// ws2812b_data_set call per LED checks every time.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_num_start   The first LED to write (1 based)
+/// @param led_num_count   The number of LEDs, one source pixel each
+/// @param p_pixels        The first source pixel
+/// @param format          Channel order and size of a source pixel
+/// @param stride          Bytes from one source pixel to the next, 0 for packed pixels
+/// @param b_reverse       Write the first pixel to the last LED of the range
+///
+/// @return TRUE on success, FALSE otherwise.  With a palette the LEDs up to
+///         a color that didn't fit are written.
+bool ws2812b_data_blit(ws2812b_t * const p_instance,
+                       size_t const led_num_start,
+                       size_t const led_num_count,
+                       uint8_t const * const p_pixels,
+                       ws2812b_pixel_format_t const format,
+                       size_t const stride,
+                       bool const b_reverse)
+{
+    bool b_result = false;
+
+    if((NULL != p_instance) &&
+       (NULL != p_pixels) &&
+       (0u < led_num_start) &&
+       (WS2812B_INIT_FAILED != p_instance->init_state) &&
+       (WS2812B_PIXEL_BGRA >= format))
+    {
+        uint8_t const * const p_layout = ws2812b_pixel_layout[format];
+        size_t const step = (0u == stride) ? p_layout[3] : stride;
+        size_t const led_idx = (led_num_start - 1u);
+
+        // Verify not beyond bounds
+        if((led_idx <= p_instance->led_count) &&
+           (led_num_count <= (p_instance->led_count - led_idx)) &&
+           (p_layout[3] <= step))
+        {
+            size_t done = led_num_count;
+
+            if(NULL != p_instance->p_palette)
+            {
+                done = ws2812b_blit_palette(p_instance, led_idx, led_num_count,
+                                            p_pixels, p_layout, step, b_reverse);
+            }
+            else
+            {
+                ws2812b_blit_grb(&p_instance->p_buffer[led_idx * WS2812B_BYTES_PER_LED],
+                                 p_pixels, led_num_count, p_layout, step, b_reverse);
+            }
+
+            if(NULL != p_instance->p_buffer16)
+            {
+                size_t const first = led_idx * WS2812B_BYTES_PER_LED;
+                size_t const end = first + (led_num_count * WS2812B_BYTES_PER_LED);
+
+                // Empty low byte, the dither gives back the 8 bit color
+                for(size_t idx = first; idx < end; idx++)
+                {
+                    p_instance->p_buffer16[idx] = (uint16_t)(p_instance->p_buffer[idx] << 8u);
+                }
+            }
+
+            if(0u < led_num_count)
+            {
+                ws2812b_add_dirty(p_instance, led_idx, led_idx + led_num_count);
+            }
+
+            b_result = (done == led_num_count);
+        }
+    }
+
+    return b_result;
+}
+
+/// Copy an array of pixels to LEDs given by an index table
+///
+/// Like ws2812b_data_blit for LEDs that are not in a row, e.g. a rotated
+/// matrix.  Every index is checked before anything is written.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param p_leds          The LED index (0 based) of each pixel
+/// @param count           The number of pixels
+/// @param p_pixels        The first source pixel
+/// @param format          Channel order and size of a source pixel
+/// @param stride          Bytes from one source pixel to the next, 0 for packed pixels
+///
+/// @return TRUE on success, FALSE otherwise.  With a palette the pixels up
+///         to a color that didn't fit are written.
+bool ws2812b_data_scatter(ws2812b_t * const p_instance,
+                          size_t const * const p_leds,
+                          size_t const count,
+                          uint8_t const * const p_pixels,
+                          ws2812b_pixel_format_t const format,
+                          size_t const stride)
+{
+    bool b_result = false;
+
+    if((NULL != p_instance) &&
+       (NULL != p_leds) &&
+       (NULL != p_pixels) &&
+       (WS2812B_INIT_FAILED != p_instance->init_state) &&
+       (WS2812B_PIXEL_BGRA >= format))
+    {
+        uint8_t const * const p_layout = ws2812b_pixel_layout[format];
+        size_t const step = (0u == stride) ? p_layout[3] : stride;
+        size_t first = p_instance->led_count;
+        size_t last = 0u;
+
+        for(size_t pixel = 0; pixel < count; pixel++)
+        {
+            first = (p_leds[pixel] < first) ? p_leds[pixel] : first;
+            last = (p_leds[pixel] > last) ? p_leds[pixel] : last;
+        }
+
+        // Verify not beyond bounds
+        if((p_layout[3] <= step) &&
+           ((0u == count) || (last < p_instance->led_count)))
+        {
+            b_result = true;
+
+            for(size_t pixel = 0; b_result && (pixel < count); pixel++)
+            {
+                uint8_t const * const p_pixel = &p_pixels[pixel * step];
+                size_t const led = p_leds[pixel];
+
+                if(NULL != p_instance->p_palette)
+                {
+                    size_t index;
+
+                    b_result = ws2812b_palette_find(p_instance,
+                                                    p_pixel[p_layout[1]],
+                                                    p_pixel[p_layout[0]],
+                                                    p_pixel[p_layout[2]],
+                                                    &index);
+
+                    if(b_result)
+                    {
+                        ws2812b_set_index(p_instance, led, 1u, index);
+                    }
+                }
+                else
+                {
+                    uint8_t * const p_led = &p_instance->p_buffer[led * WS2812B_BYTES_PER_LED];
+
+                    p_led[0] = p_pixel[p_layout[0]];
+                    p_led[1] = p_pixel[p_layout[1]];
+                    p_led[2] = p_pixel[p_layout[2]];
+
+                    if(NULL != p_instance->p_buffer16)
+                    {
+                        uint16_t * const p_led16 = &p_instance->p_buffer16[led * WS2812B_BYTES_PER_LED];
+
+                        // Empty low byte, the dither gives back the 8 bit color
+                        p_led16[0] = (uint16_t)(p_led[0] << 8u);
+                        p_led16[1] = (uint16_t)(p_led[1] << 8u);
+                        p_led16[2] = (uint16_t)(p_led[2] << 8u);
+                    }
+                }
+            }
+
+            if(0u < count)
+            {
+                ws2812b_add_dirty(p_instance, first, last + 1u);
+            }
+        }
+    }
+
+    return b_result;
+}
+
+
+/// Add a span of LEDs to a list of spans
+///
+/// Spans that touch or overlap are merged.  When the list already holds
+/// WS2812B_DIRTY_SPAN_MAX spans the nearest one is grown over the new one,
+/// so the list never grows past that and never loses a LED.
+///
+/// @param p_spans The list, room for WS2812B_DIRTY_SPAN_MAX spans
+/// @param p_count The number of spans in the list, updated
+/// @param start   First LED of the span (0 based)
+/// @param end     One past the last LED of the span
+void ws2812b_data_span_add(ws2812b_span_t * const p_spans,
+                           size_t * const p_count,
+                           size_t start,
+                           size_t end)
+{
+    size_t count = *p_count;
+    bool b_merged = true;
+
+    while(b_merged)
+    {
+        b_merged = false;
+
+        for(size_t idx = 0; idx < count; idx++)
+        {
+            if((p_spans[idx].start <= end) && (start <= p_spans[idx].end))
+            {
+                b_merged = true;
+            }
+            // No room for another span, fold the nearest one in
+            else if((idx + 1u == count) &&
+                    (WS2812B_DIRTY_SPAN_MAX <= count))
+            {
+                size_t best_gap = (size_t)-1;
+
+                for(size_t near = 0; near < count; near++)
+                {
+                    size_t const gap = (p_spans[near].end < start) ?
+                        (start - p_spans[near].end) : (p_spans[near].start - end);
+
+                    if(gap < best_gap)
+                    {
+                        best_gap = gap;
+                        idx = near;
+                    }
+                }
+
+                b_merged = true;
+            }
+
+            if(b_merged)
+            {
+                start = (p_spans[idx].start < start) ? p_spans[idx].start : start;
+                end = (p_spans[idx].end > end) ? p_spans[idx].end : end;
+
+                // Drop the merged span, the grown span is re-checked
+                p_spans[idx] = p_spans[count - 1u];
+                count--;
+                break;
+            }
+        }
+    }
+
+    p_spans[count].start = start;
+    p_spans[count].end = end;
+    *p_count = count + 1u;
+}
+
+/// Sort a list of spans by their first LED
+///
+/// @param p_spans The list
+/// @param count   The number of spans in the list
+static void ws2812b_spans_sort(ws2812b_span_t * const p_spans,
+                               size_t const count)
+{
+    for(size_t idx = 1; idx < count; idx++)
+    {
+        ws2812b_span_t const span = p_spans[idx];
+        size_t pos = idx;
+
+        while((0u < pos) && (p_spans[pos - 1u].start > span.start))
+        {
+            p_spans[pos] = p_spans[pos - 1u];
+            pos--;
+        }
+
+        p_spans[pos] = span;
+    }
+}
+
+/// Mark LEDs as changed so the next stream update encodes them
+///
+/// Only needed when the app writes p_buffer directly, the set functions
+/// already track what they change.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_num_start   The first LED that changed (1 based)
+/// @param led_num_count   The number of LEDs that changed from led_num_start
+void ws2812b_data_mark_dirty(ws2812b_t * const p_instance,
+                             size_t const led_num_start,
+                             size_t const led_num_count)
+{
+    if((NULL != p_instance) && (0 < led_num_start))
+    {
+        size_t const start = led_num_start - 1u;
+        size_t end = start + led_num_count;
+
+        // Clamp to the strip
+        end = (end > p_instance->led_count) ? p_instance->led_count : end;
+
+        if(start < end)
+        {
+            ws2812b_add_dirty(p_instance, start, end);
+        }
+    }
+}
+
+/// Mark every LED as changed so the next stream update encodes the full strip
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+void ws2812b_data_mark_dirty_all(ws2812b_t * const p_instance)
+{
+    if(NULL != p_instance)
+    {
+        p_instance->dirty[0].start = 0u;
+        p_instance->dirty[0].end = p_instance->led_count;
+        p_instance->dirty_count = (0u < p_instance->led_count) ? 1u : 0u;
+        p_instance->tx_dirty = p_instance->dirty[0];
+    }
+}
+
+/// Check if any LED changed since the last stream update
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+///
+/// @return TRUE if the stream is out of date, FALSE otherwise
+bool ws2812b_data_is_dirty(ws2812b_t const * const p_instance)
+{
+    return (NULL != p_instance) && (0u < p_instance->dirty_count);
+}
+
+/// Get the number of stream bytes each LED encodes to
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+///
+/// @return Stream bytes per LED, 0 if the instance is not initialized
+size_t ws2812b_data_stream_bytes_per_led(ws2812b_t const * const p_instance)
+{
+    return (NULL != p_instance) ?
+        ws2812b_bytes_per_led(p_instance->init_state, p_instance->p_encoder) : 0u;
+}
+
+/// Encode a range of LEDs into a caller provided buffer
+///
+/// Uses the stream format the instance was initialized for.  The dirty
+/// state is not changed.  This is the building block for streaming the
+/// data out in pieces instead of through ws2812b_t::p_stream.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param p_dst           Where to write the stream of led_num_start, must hold
+///                        led_num_count * ws2812b_data_stream_bytes_per_led bytes
+/// @param led_num_start   The first LED to encode (1 based)
+/// @param led_num_count   The number of LEDs to encode from led_num_start
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_encode(ws2812b_t const * const p_instance,
+                         uint8_t * const p_dst,
+                         size_t const led_num_start,
+                         size_t const led_num_count)
+{
+    bool b_result = false;
+
+    if((NULL != p_dst) &&
+       (0u < led_num_start) &&
+       (0u < ws2812b_data_stream_bytes_per_led(p_instance)))
+    {
+        size_t const led_idx = (led_num_start - 1u);
+
+        // Verify not beyond bounds
+        if((led_idx <= p_instance->led_count) &&
+           (led_num_count <= (p_instance->led_count - led_idx)))
+        {
+            ws2812b_encode_span(p_instance, p_dst, led_idx, led_num_count);
+            b_result = true;
+        }
+    }
+
+    return b_result;
+}
+
+/// Dither a range of LEDs from the 16 bit buffer into the storage buffer
+///
+/// ws2812b_update_stream dithers every LED as it encodes.  Modules that
+/// encode through ws2812b_data_encode instead (ws2812b_chunk, ws2812b_pool)
+/// call this for each range first, once per frame, so the rounding error
+/// carries to the next frame the same way.  Ranges that don't overlap can
+/// be dithered from different threads.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_num_start   The first LED to dither (1 based)
+/// @param led_num_count   The number of LEDs to dither from led_num_start
+///
+/// @return TRUE on success, FALSE if there is no 16 bit buffer
+bool ws2812b_data_dither(ws2812b_t * const p_instance,
+                         size_t const led_num_start,
+                         size_t const led_num_count)
+{
+    bool b_result = false;
+
+    if((0u < led_num_start) &&
+       (0u < ws2812b_data_stream_bytes_per_led(p_instance)) &&
+       (NULL != p_instance->p_buffer16))
+    {
+        size_t const led_idx = (led_num_start - 1u);
+
+        // Verify not beyond bounds
+        if((led_idx <= p_instance->led_count) &&
+           (led_num_count <= (p_instance->led_count - led_idx)))
+        {
+            size_t const first = led_idx * WS2812B_BYTES_PER_LED;
+
+            ws2812b_dither(&p_instance->p_buffer16[first],
+                           &p_instance->p_dither[first],
+                           &p_instance->p_buffer[first],
+                           led_num_count * WS2812B_BYTES_PER_LED);
+            b_result = true;
+        }
+    }
+
+    return b_result;
+}
+
+/// Encode a single LED color into its stream pattern
+///
+/// Lets a caller encode a color once and then copy it to many LEDs with
+/// ws2812b_data_stream_fill, without going through the storage buffer.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param red             The red value
+/// @param green           The green value
+/// @param blue            The blue value
+/// @param p_pattern       Where to write the pattern, must hold
+///                        ws2812b_data_stream_bytes_per_led bytes
+///                        (WS2812B_LED_PATTERN_MAX covers every format)
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_encode_color(ws2812b_t const * const p_instance,
+                               uint8_t const red,
+                               uint8_t const green,
+                               uint8_t const blue,
+                               uint8_t * const p_pattern)
+{
+    bool b_result = false;
+
+    if((NULL != p_pattern) && (0u < ws2812b_data_stream_bytes_per_led(p_instance)))
+    {
+        uint8_t const grb[WS2812B_BYTES_PER_LED] = {green, red, blue};
+
+        ws2812b_encode_bytes(p_instance, p_pattern, grb, WS2812B_BYTES_PER_LED);
+        b_result = true;
+    }
+
+    return b_result;
+}
+
+/// Copy an encoded LED pattern straight into the stream buffer for X LEDs
+///
+/// The storage buffer and dirty state are not touched, so this is meant
+/// for apps that render directly into the stream (ws2812b_draw stream mode)
+/// instead of calling the ws2812b_update_stream... functions.  An in place
+/// strip keeps its storage in the stream, so it is refused.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_num_start   The LED start position to update (1 based)
+/// @param led_num_to_set  The number of LEDs to update from led_num_start
+/// @param p_pattern       Pattern from ws2812b_data_encode_color
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_data_stream_fill(ws2812b_t * const p_instance,
+                              size_t const led_num_start,
+                              size_t const led_num_to_set,
+                              uint8_t const * const p_pattern)
+{
+    bool b_result = false;
+    size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+
+    if((NULL != p_pattern) &&
+       (0u < led_num_start) &&
+       (0u < bytes_per_led) &&
+       (NULL != p_instance->p_stream) &&
+       !p_instance->b_in_place)
+    {
+        size_t const led_idx = (led_num_start - 1u);
+
+        // Verify not beyond bounds
+        if((led_idx <= p_instance->led_count) &&
+           (led_num_to_set <= (p_instance->led_count - led_idx)))
+        {
+            uint8_t * const p_dst = &p_instance->p_stream[led_idx * bytes_per_led];
+
+            ws2812b_add_tx_dirty(p_instance, led_idx, led_idx + led_num_to_set);
+
+            if(0u < led_num_to_set)
+            {
+                memcpy(p_dst, p_pattern, bytes_per_led);
+                ws2812b_replicate(p_dst, bytes_per_led, led_num_to_set * bytes_per_led);
+            }
+
+            b_result = true;
+        }
+    }
+
+    return b_result;
+}
+
+/// Find how much of the stream has to be sent
+///
+/// The LEDs latch whatever arrives before the reset and keep their color
+/// otherwise, so only the stream up to the last changed LED needs sending.
+/// Without ws2812b_t::p_shadow this is the last LED changed through the
+/// set, mark dirty and stream fill functions since the last
+/// ws2812b_data_tx_commit.  With a shadow (a copy of the last sent stream,
+/// ws2812b_t::shadow_sz bytes) those LEDs are also compared, so LEDs set
+/// back to the color they already show are not sent.
+///
+/// Call after the stream is updated, send p_stream_len bytes of
+/// ws2812b_t::p_stream and the reset, then call ws2812b_data_tx_commit.
+/// The stream must not change in between.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param p_stream_len    Set to the number of stream bytes to send
+///
+/// @return WS2812B_TX_NONE, WS2812B_TX_PARTIAL or WS2812B_TX_FULL
+ws2812b_tx_t ws2812b_data_tx_prepare(ws2812b_t * const p_instance,
+                                     size_t * const p_stream_len)
+{
+    ws2812b_tx_t tx = WS2812B_TX_NONE;
+    size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+    size_t len = 0u;
+
+    if((0u < bytes_per_led) && (NULL != p_instance->p_stream))
+    {
+        size_t const start = p_instance->tx_dirty.start;
+        size_t end = p_instance->tx_dirty.end;
+
+        if(!p_instance->b_shadow_valid)
+        {
+            // What the strip shows is unknown, send it all
+            end = p_instance->led_count;
+        }
+        else if(NULL != p_instance->p_shadow)
+        {
+            // Drop changed LEDs from the far end that match what was sent
+            while((start < end) &&
+                  (0 == memcmp(&p_instance->p_stream[(end - 1u) * bytes_per_led],
+                               &p_instance->p_shadow[(end - 1u) * bytes_per_led],
+                               bytes_per_led)))
+            {
+                end--;
+            }
+        }
+
+        if(start < end)
+        {
+            len = end * bytes_per_led;
+            tx = (end < p_instance->led_count) ? WS2812B_TX_PARTIAL : WS2812B_TX_FULL;
+        }
+
+        p_instance->tx_len = len;
+    }
+
+    if(NULL != p_stream_len)
+    {
+        *p_stream_len = len;
+    }
+
+    return tx;
+}
+
+/// Record that the stream from ws2812b_data_tx_prepare was sent
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+void ws2812b_data_tx_commit(ws2812b_t * const p_instance)
+{
+    size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+
+    if((0u < bytes_per_led) && (NULL != p_instance->p_stream))
+    {
+        size_t const full = p_instance->led_count * bytes_per_led;
+
+        if(NULL != p_instance->p_shadow)
+        {
+            // Only the changed LEDs can differ from the shadow
+            size_t const from = p_instance->b_shadow_valid ?
+                (p_instance->tx_dirty.start * bytes_per_led) : 0u;
+
+            if(from < p_instance->tx_len)
+            {
+                memcpy(&p_instance->p_shadow[from],
+                       &p_instance->p_stream[from],
+                       p_instance->tx_len - from);
+            }
+        }
+
+        // A full frame puts every LED in a known state
+        if((0u < full) && (full == p_instance->tx_len))
+        {
+            p_instance->b_shadow_valid = true;
+        }
+
+        if(p_instance->b_shadow_valid)
+        {
+            p_instance->tx_dirty.start = 0u;
+            p_instance->tx_dirty.end = 0u;
+        }
+
+        p_instance->tx_len = 0u;
+    }
+}
+
+/// Populate the stream buffer with storage buffer
+///
+/// Works for every stream format the instance can be initialized for.
+/// Only the LEDs changed since the last update are encoded, the rest of
+/// the stream is already up to date.
+///
+/// @note that the reset is not part of the stream
+/// It is up to the application to delay before sending another stream
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+void ws2812b_update_stream(ws2812b_t * const p_instance)
+{
+    size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+
+    if((0u < bytes_per_led) && (NULL != p_instance->p_stream) &&
+       (NULL != p_instance->p_buffer16))
+    {
+        ws2812b_update_dithered(p_instance, bytes_per_led);
+    }
+    else if((0u < bytes_per_led) && (NULL != p_instance->p_stream) &&
+            !(p_instance->b_in_place && p_instance->b_encoded))
+    {
+        if(p_instance->b_in_place)
+        {
+            // The patterns of LEDs from here on overlap the storage and
+            // were overwritten by it
+            size_t const tail_led =
+                (p_instance->led_count * (bytes_per_led - WS2812B_BYTES_PER_LED)) / bytes_per_led;
+
+            if(tail_led < p_instance->led_count)
+            {
+                ws2812b_data_span_add(p_instance->dirty, &p_instance->dirty_count,
+                                      tail_led, p_instance->led_count);
+            }
+
+            // A pattern overwrites the storage of lower LEDs, so the spans
+            // must go front to back or colors would be read after they
+            // were overwritten
+            ws2812b_spans_sort(p_instance->dirty, p_instance->dirty_count);
+
+            // The storage is gone until ws2812b_data_restore, encoding
+            // again would read patterns as colors
+            p_instance->b_encoded = true;
+        }
+
+        for(size_t idx = 0; idx < p_instance->dirty_count; idx++)
+        {
+            ws2812b_span_t const * const p_span = &p_instance->dirty[idx];
+
+            ws2812b_encode_span(p_instance,
+                                &p_instance->p_stream[p_span->start * bytes_per_led],
+                                p_span->start,
+                                p_span->end - p_span->start);
+        }
+
+        p_instance->dirty_count = 0u;
+    }
+}
+
+/// Populate 2.5Mhz stream buffer with storage buffer
+///
+/// Every 1 bit is converted to a stream of  3 bits
+/// So a 1 bit will be 110 and a 0 bit will be 100
+///
+/// Only the LEDs changed since the last update are encoded, the rest of
+/// the stream is already up to date.
+///
+/// @note that the reset is not part of the stream
+/// It is up to the application to delay before sending another stream
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+void ws2812b_update_stream_2p5mhz(ws2812b_t * const p_instance)
+{
+    if(p_instance->init_state == WS2812B_INIT_2p5MHz)
+    {
+        ws2812b_update_stream(p_instance);
+    }
+}
+
+/// Populate 5Mhz stream buffer with storage buffer
+///
+/// Every 1 bit is converted to a stream of  6 bits
+/// So a 1 bit will be 111100 and a 0 bit will be 110000
+///
+/// Only the LEDs changed since the last update are encoded, the rest of
+/// the stream is already up to date.
+///
+/// @note that the reset is not part of the stream
+/// It is up to the application to delay before sending another stream
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+void ws2812b_update_stream_5mhz(ws2812b_t * const p_instance)
+{
+    if(p_instance->init_state == WS2812B_INIT_5MHz)
+    {
+        ws2812b_update_stream(p_instance);
+    }
+}
+
+/// Populate UART stream buffer with storage buffer
+///
+/// Every 3 bits are converted to a UART character for 2.5Mbaud 7N1 with
+/// the TX line inverted, 8 characters per LED.  The start and stop bits are
+/// part of the waveform, so the characters must go out back to back with
+/// no idle time between them (one stop bit, DMA or a FIFO kept filled).
+///
+/// Only the LEDs changed since the last update are encoded, the rest of
+/// the stream is already up to date.
+///
+/// @note that the reset is not part of the stream
+/// It is up to the application to delay before sending another stream
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+void ws2812b_update_stream_uart(ws2812b_t * const p_instance)
+{
+    if(p_instance->init_state == WS2812B_INIT_UART)
+    {
+        ws2812b_update_stream(p_instance);
+    }
+}
+
+/// Write 16 bit colors into the 16 bit buffer
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_idx         First LED index to set (0 based)
+/// @param led_cnt         The number of LEDs to set
+/// @param red             The red value
+/// @param green           The green value
+/// @param blue            The blue value
+static void ws2812b_set16(ws2812b_t * const p_instance,
+                          size_t const led_idx,
+                          size_t const led_cnt,
+                          uint16_t const red,
+                          uint16_t const green,
+                          uint16_t const blue)
+{
+    uint16_t * p_led = &p_instance->p_buffer16[led_idx * WS2812B_BYTES_PER_LED];
+
+    for(size_t idx = 0; idx < led_cnt; idx++)
+    {
+        p_led[0] = green;
+        p_led[1] = red;
+        p_led[2] = blue;
+        p_led += WS2812B_BYTES_PER_LED;
+    }
+}
+
+/// Dither the 16 bit buffer into the storage buffer and encode it
+///
+/// Every LED is done each frame, since the dithered output changes even
+/// when the colors do not.  Works a block of WS2812B_DITHER_BLOCK_LEDS at a
+/// time, so the dithered bytes are still in cache when they are encoded.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param bytes_per_led   Stream bytes per LED of the instance
+static void ws2812b_update_dithered(ws2812b_t * const p_instance,
+                                    size_t const bytes_per_led)
+{
+    for(size_t led = 0; led < p_instance->led_count; led += WS2812B_DITHER_BLOCK_LEDS)
+    {
+        size_t const left = p_instance->led_count - led;
+        size_t const count = (left < WS2812B_DITHER_BLOCK_LEDS) ? left : WS2812B_DITHER_BLOCK_LEDS;
+        size_t const first = led * WS2812B_BYTES_PER_LED;
+
+        ws2812b_dither(&p_instance->p_buffer16[first],
+                       &p_instance->p_dither[first],
+                       &p_instance->p_buffer[first],
+                       count * WS2812B_BYTES_PER_LED);
+        ws2812b_encode_span(p_instance, &p_instance->p_stream[led * bytes_per_led], led, count);
+    }
+
+    p_instance->dirty_count = 0u;
+
+    if(0u < p_instance->led_count)
+    {
+        ws2812b_add_tx_dirty(p_instance, 0u, p_instance->led_count);
+    }
+}
+
+/// Quantize 16 bit channels to 8 bits, carrying the error to the next frame
+///
+/// The channels and errors are matching flat arrays, so whole blocks go
+/// through the vector kernel when there is one.
+///
+/// @param p_src    The 16 bit channels
+/// @param p_error  The error left from the last frame, updated
+/// @param p_dst    Where to write the 8 bit channels
+/// @param size     The number of channels
+static void ws2812b_dither(uint16_t const * const p_src,
+                           uint8_t * const p_error,
+                           uint8_t * const p_dst,
+                           size_t const size)
+{
+    size_t i = 0;
+    ws2812b_simd_kernels_t const * const p_simd = ws2812b_simd_kernels();
+
+    if(NULL != p_simd->dither)
+    {
+        i = p_simd->dither(p_dst, p_error, p_src, size);
+    }
+
+    for(; i < size; i++)
+    {
+        uint32_t sum = (uint32_t)p_src[i] + p_error[i];
+
+        // A full channel stays at 0xFF
+        sum = (sum > 0xFFFFu) ? 0xFFFFu : sum;
+
+        p_dst[i] = (uint8_t)(sum >> 8u);
+        p_error[i] = (uint8_t)sum;
+    }
+}
+
+/// Encode LEDs with the stream format of the instance
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param p_dst           Where to write the stream of the first LED
+/// @param led_idx         First LED index to encode (0 based)
+/// @param led_cnt         The number of LEDs to encode
+static void ws2812b_encode_span(ws2812b_t const * const p_instance,
+                                uint8_t * const p_dst,
+                                size_t const led_idx,
+                                size_t const led_cnt)
+{
+    if(NULL != p_instance->p_palette)
+    {
+        ws2812b_encode_palette(p_instance, p_dst, led_idx, led_cnt);
+    }
+    else if(p_instance->b_encode_runs)
+    {
+        ws2812b_encode_runs(p_instance,
+                            p_dst,
+                            &p_instance->p_buffer[led_idx * WS2812B_BYTES_PER_LED],
+                            led_cnt);
+    }
+    else
+    {
+        ws2812b_encode_bytes(p_instance,
+                             p_dst,
+                             &p_instance->p_buffer[led_idx * WS2812B_BYTES_PER_LED],
+                             led_cnt * WS2812B_BYTES_PER_LED);
+    }
+}
+
+/// Encode storage LEDs, copying the pattern over runs of equal LEDs
+///
+/// LEDs between runs are encoded together as usual.  A run of at least
+/// WS2812B_RUN_LEDS_MIN LEDs has its first LED encoded and the pattern
+/// doubled over the rest, so black or solid spans cost about a memset.
+/// Writes front to back like the plain encode, as in place needs.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param p_dst           Where to write the stream of the first LED
+/// @param p_src           The storage of the first LED
+/// @param led_cnt         The number of LEDs to encode
+static void ws2812b_encode_runs(ws2812b_t const * const p_instance,
+                                uint8_t * const p_dst,
+                                uint8_t const * const p_src,
+                                size_t const led_cnt)
+{
+    size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+    size_t encoded = 0u;
+    size_t led = 0u;
+
+    while(led < led_cnt)
+    {
+        uint8_t const * const p_led = &p_src[led * WS2812B_BYTES_PER_LED];
+        size_t run = 1u;
+
+        // A run long enough to copy ends on a LED equal to its first
+        if(((led + WS2812B_RUN_LEDS_MIN) <= led_cnt) &&
+           (0 == memcmp(p_led, &p_led[(WS2812B_RUN_LEDS_MIN - 1u) * WS2812B_BYTES_PER_LED], WS2812B_BYTES_PER_LED)))
+        {
+            run = ws2812b_run_length(p_led, led_cnt - led);
+        }
+
+        if(WS2812B_RUN_LEDS_MIN <= run)
+        {
+            // The LEDs since the last run first
+            ws2812b_encode_bytes(p_instance,
+                                 &p_dst[encoded * bytes_per_led],
+                                 &p_src[encoded * WS2812B_BYTES_PER_LED],
+                                 (led + 1u - encoded) * WS2812B_BYTES_PER_LED);
+            ws2812b_replicate(&p_dst[led * bytes_per_led], bytes_per_led, run * bytes_per_led);
+            encoded = led + run;
+        }
+
+        led += run;
+    }
+
+    ws2812b_encode_bytes(p_instance,
+                         &p_dst[encoded * bytes_per_led],
+                         &p_src[encoded * WS2812B_BYTES_PER_LED],
+                         (led_cnt - encoded) * WS2812B_BYTES_PER_LED);
+}
+
+/// Count the LEDs equal to the first one
+///
+/// Equal LEDs in a row means every storage byte matches the one a LED
+/// before it, which is compared a word at a time.
+///
+/// @param p_src           The storage of the first LED
+/// @param led_cnt         The number of LEDs that may be in the run
+///
+/// @return The number of LEDs in the run, at least 1
+static size_t ws2812b_run_length(uint8_t const * const p_src,
+                                 size_t const led_cnt)
+{
+    size_t const size = (led_cnt - 1u) * WS2812B_BYTES_PER_LED;
+    size_t same = 0u;
+
+    while(((same + WS2812B_REPLICATE_BLOCK) <= size) &&
+          (0 == memcmp(&p_src[same], &p_src[same + WS2812B_BYTES_PER_LED], WS2812B_REPLICATE_BLOCK)))
+    {
+        same += WS2812B_REPLICATE_BLOCK;
+    }
+
+    while(((same + sizeof(uint64_t)) <= size) &&
+          (0 == memcmp(&p_src[same], &p_src[same + WS2812B_BYTES_PER_LED], sizeof(uint64_t))))
+    {
+        same += sizeof(uint64_t);
+    }
+
+    while((same < size) && (p_src[same] == p_src[same + WS2812B_BYTES_PER_LED]))
+    {
+        same++;
+    }
+
+    return 1u + (same / WS2812B_BYTES_PER_LED);
+}
+
+/// Repeat the pattern at the start of a buffer until it is total bytes long
+///
+/// @param p_dst           The buffer, starting with one pattern
+/// @param pattern_sz      The size of the pattern
+/// @param total           The size to fill, a multiple of pattern_sz
+static void ws2812b_replicate(uint8_t * const p_dst,
+                              size_t const pattern_sz,
+                              size_t const total)
+{
+    uint8_t block[2u * WS2812B_REPLICATE_BLOCK];
+    size_t filled = pattern_sz;
+
+    // The pattern repeated to cover a block store.  Copying from here
+    // avoids reading back stream bytes that were just written, which
+    // stalls on the store buffer.  Fixed size copies for the built in
+    // formats compile to plain moves.
+    if(WS2812_BYTES_PER_LED_2P5MHZ == pattern_sz)
+    {
+        for(size_t idx = 0; idx < WS2812B_REPLICATE_BLOCK; idx += WS2812_BYTES_PER_LED_2P5MHZ)
+        {
+            memcpy(&block[idx], p_dst, WS2812_BYTES_PER_LED_2P5MHZ);
+        }
+    }
+    else if(WS2812_BYTES_PER_LED_5MHZ == pattern_sz)
+    {
+        for(size_t idx = 0; idx < WS2812B_REPLICATE_BLOCK; idx += WS2812_BYTES_PER_LED_5MHZ)
+        {
+            memcpy(&block[idx], p_dst, WS2812_BYTES_PER_LED_5MHZ);
+        }
+    }
+    else
+    {
+        memcpy(block, p_dst, pattern_sz);
+
+        for(size_t built = pattern_sz; built < WS2812B_REPLICATE_BLOCK; built *= 2u)
+        {
+            memcpy(&block[built], block, built);
+        }
+    }
+
+    // Whole patterns per store, the bytes after them are overwritten next
+    for(size_t const step = (WS2812B_REPLICATE_BLOCK / pattern_sz) * pattern_sz;
+        (filled + WS2812B_REPLICATE_BLOCK) <= total;
+        filled += step)
+    {
+        memcpy(&p_dst[filled], block, WS2812B_REPLICATE_BLOCK);
+    }
+
+    if(filled < total)
+    {
+        memcpy(&p_dst[filled], block, total - filled);
+    }
+}
+
+/// Check the palette of an instance fits the strip and stream format
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param bytes_per_led   Stream bytes per LED of the format
+///
+/// @return TRUE if there is no palette or it is usable, FALSE otherwise
+static bool ws2812b_palette_check(ws2812b_t const * const p_instance,
+                                  size_t const bytes_per_led)
+{
+    ws2812b_palette_t const * const p_palette = p_instance->p_palette;
+    bool b_result = (NULL == p_palette);
+
+    if(!b_result)
+    {
+        size_t const entries = (size_t)1u << ((8u == p_palette->index_bits) ? 8u : 4u);
+
+        // The 16 bit buffer dithers colors, it can't go through a palette
+        b_result = ((8u == p_palette->index_bits) || (4u == p_palette->index_bits)) &&
+                   (NULL != p_palette->p_colors) &&
+                   (NULL != p_palette->p_patterns) &&
+                   (p_palette->size <= entries) &&
+                   (p_palette->count <= p_palette->size) &&
+                   ((p_palette->size * bytes_per_led) <= p_palette->patterns_sz) &&
+                   (NULL == p_instance->p_buffer16);
+    }
+
+    return b_result;
+}
+
+/// Encode palette colors into their stream patterns
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param first           First entry to encode
+/// @param count           The number of entries to encode
+static void ws2812b_palette_build(ws2812b_t const * const p_instance,
+                                  size_t const first,
+                                  size_t const count)
+{
+    ws2812b_palette_t * const p_palette = p_instance->p_palette;
+    size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+
+    ws2812b_encode_bytes(p_instance,
+                         &p_palette->p_patterns[first * bytes_per_led],
+                         &p_palette->p_colors[first * WS2812B_BYTES_PER_LED],
+                         count * WS2812B_BYTES_PER_LED);
+}
+
+/// Find a color in the palette, adding it when it is not there
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param red             The red value
+/// @param green           The green value
+/// @param blue            The blue value
+/// @param p_index         Set to the palette entry of the color
+///
+/// @return TRUE on success, FALSE if the color is new and the palette is full
+static bool ws2812b_palette_find(ws2812b_t * const p_instance,
+                                 uint8_t const red,
+                                 uint8_t const green,
+                                 uint8_t const blue,
+                                 size_t * const p_index)
+{
+    ws2812b_palette_t const * const p_palette = p_instance->p_palette;
+    uint8_t const * p_color = p_palette->p_colors;
+    bool b_result = false;
+
+    for(size_t index = 0; (index < p_palette->count) && !b_result; index++)
+    {
+        if((p_color[0] == green) && (p_color[1] == red) && (p_color[2] == blue))
+        {
+            *p_index = index;
+            b_result = true;
+        }
+
+        p_color += WS2812B_BYTES_PER_LED;
+    }
+
+    if(!b_result && (p_palette->count < p_palette->size))
+    {
+        *p_index = p_palette->count;
+        b_result = ws2812b_data_palette_set(p_instance, p_palette->count, red, green, blue);
+    }
+
+    return b_result;
+}
+
+/// Write a palette index for LEDs
+///
+/// With 4 bit indices the even LED of a byte is the high nibble.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_idx         First LED index to set (0 based)
+/// @param led_cnt         The number of LEDs to set
+/// @param index           The palette entry
+static void ws2812b_set_index(ws2812b_t * const p_instance,
+                              size_t const led_idx,
+                              size_t const led_cnt,
+                              size_t const index)
+{
+    uint8_t * const p_buffer = p_instance->p_buffer;
+
+    if(8u == p_instance->p_palette->index_bits)
+    {
+        memset(&p_buffer[led_idx], (int)index, led_cnt);
+    }
+    else
+    {
+        size_t led = led_idx;
+        size_t const end = led_idx + led_cnt;
+
+        // Odd LEDs at either end share a byte with a LED that stays
+        if((led < end) && (0u != (led & 1u)))
+        {
+            p_buffer[led / 2u] = (uint8_t)((p_buffer[led / 2u] & 0xF0u) | index);
+            led++;
+        }
+
+        memset(&p_buffer[led / 2u], (int)((index << 4u) | index), (end - led) / 2u);
+        led += (end - led) & ~(size_t)1u;
+
+        if(led < end)
+        {
+            p_buffer[led / 2u] = (uint8_t)((p_buffer[led / 2u] & 0x0Fu) | (index << 4u));
+        }
+    }
+}
+
+/// Encode LEDs of an instance that stores palette indices
+///
+/// Each LED is a copy of its palette entry's pattern.  The copies for the
+/// built in formats with 8 bit indices are fixed size so they compile to
+/// plain moves.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param p_dst           Where to write the stream of the first LED
+/// @param led_idx         First LED index to encode (0 based)
+/// @param led_cnt         The number of LEDs to encode
+static void ws2812b_encode_palette(ws2812b_t const * const p_instance,
+                                   uint8_t * const p_dst,
+                                   size_t const led_idx,
+                                   size_t const led_cnt)
+{
+    uint8_t const * const p_buffer = p_instance->p_buffer;
+    uint8_t const * const p_patterns = p_instance->p_palette->p_patterns;
+    size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+    bool const b_nibbles = (4u == p_instance->p_palette->index_bits);
+    uint8_t * p_out = p_dst;
+
+    if(!b_nibbles && (WS2812_BYTES_PER_LED_2P5MHZ == bytes_per_led))
+    {
+        for(size_t led = led_idx; led < (led_idx + led_cnt); led++)
+        {
+            memcpy(p_out, &p_patterns[p_buffer[led] * WS2812_BYTES_PER_LED_2P5MHZ],
+                   WS2812_BYTES_PER_LED_2P5MHZ);
+            p_out += WS2812_BYTES_PER_LED_2P5MHZ;
+        }
+    }
+    else if(!b_nibbles && (WS2812_BYTES_PER_LED_5MHZ == bytes_per_led))
+    {
+        for(size_t led = led_idx; led < (led_idx + led_cnt); led++)
+        {
+            memcpy(p_out, &p_patterns[p_buffer[led] * WS2812_BYTES_PER_LED_5MHZ],
+                   WS2812_BYTES_PER_LED_5MHZ);
+            p_out += WS2812_BYTES_PER_LED_5MHZ;
+        }
+    }
+    else
+    {
+        for(size_t led = led_idx; led < (led_idx + led_cnt); led++)
+        {
+            size_t const index = b_nibbles ?
+                ((p_buffer[led / 2u] >> ((0u != (led & 1u)) ? 0u : 4u)) & 0x0Fu) :
+                p_buffer[led];
+
+            memcpy(p_out, &p_patterns[index * bytes_per_led], bytes_per_led);
+            p_out += bytes_per_led;
+        }
+    }
+}
+
+/// Encode storage bytes with the stream format and color table of the instance
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param p_dst           Where to write the stream bytes
+/// @param p_src           The storage bytes (GRB, whole LEDs) to encode
+/// @param size            The number of storage bytes to encode
+static void ws2812b_encode_bytes(ws2812b_t const * const p_instance,
+                                 uint8_t * const p_dst,
+                                 uint8_t const * const p_src,
+                                 size_t const size)
+{
+    if((NULL != p_instance->p_color) && (WS2812B_INIT_UART == p_instance->init_state))
+    {
+        // Characters span storage bytes, the table holds corrected levels
+        ws2812b_encode_uart(p_instance->p_color, p_dst, p_src, size);
+    }
+    else if(NULL != p_instance->p_color)
+    {
+        ws2812b_encode_color_table(p_instance->p_color, p_dst, p_src, size,
+            ws2812b_data_stream_bytes_per_led(p_instance) / WS2812B_BYTES_PER_LED);
+    }
+    else
+    {
+        ws2812b_encode_format(p_instance, p_dst, p_src, size);
+    }
+}
+
+/// Encode storage bytes with the stream format of the instance, uncorrected
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param p_dst           Where to write the stream bytes
+/// @param p_src           The storage bytes to encode
+/// @param size            The number of storage bytes to encode
+static void ws2812b_encode_format(ws2812b_t const * const p_instance,
+                                  uint8_t * const p_dst,
+                                  uint8_t const * const p_src,
+                                  size_t const size)
+{
+    if(WS2812B_INIT_2p5MHz == p_instance->init_state)
+    {
+        ws2812b_encode_2p5mhz(p_dst, p_src, size);
+    }
+    else if(WS2812B_INIT_5MHz == p_instance->init_state)
+    {
+        ws2812b_encode_5mhz(p_dst, p_src, size);
+    }
+    else if(WS2812B_INIT_CUSTOM == p_instance->init_state)
+    {
+        ws2812b_encode_custom(p_instance->p_encoder, p_dst, p_src, size);
+    }
+    else if(WS2812B_INIT_UART == p_instance->init_state)
+    {
+        ws2812b_encode_uart(NULL, p_dst, p_src, size);
+    }
+}
+
+/// Copy source pixels into GRB storage
+///
+/// @param p_dst           The storage of the first LED
+/// @param p_src           The first source pixel
+/// @param count           The number of LEDs
+/// @param p_layout        Source offsets of green, red and blue, then the pixel size
+/// @param step            Bytes from one source pixel to the next
+/// @param b_reverse       Write the first pixel to the last LED
+static void ws2812b_blit_grb(uint8_t * const p_dst,
+                             uint8_t const * const p_src,
+                             size_t const count,
+                             uint8_t const * const p_layout,
+                             size_t const step,
+                             bool const b_reverse)
+{
+    size_t done = 0u;
+    ws2812b_simd_kernels_t const * const p_simd = ws2812b_simd_kernels();
+
+    // The kernel only handles packed pixels
+    if((NULL != p_simd->swizzle) && (p_layout[3] == step))
+    {
+        done = p_simd->swizzle(p_dst, p_src, count, p_layout, step, b_reverse);
+    }
+
+    for(size_t pixel = done; pixel < count; pixel++)
+    {
+        uint8_t const * const p_pixel = &p_src[pixel * step];
+        uint8_t * const p_led =
+            &p_dst[(b_reverse ? (count - 1u - pixel) : pixel) * WS2812B_BYTES_PER_LED];
+
+        p_led[0] = p_pixel[p_layout[0]];
+        p_led[1] = p_pixel[p_layout[1]];
+        p_led[2] = p_pixel[p_layout[2]];
+    }
+}
+
+/// Set palette indices from source pixels
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param led_idx         First LED index to set (0 based)
+/// @param count           The number of LEDs
+/// @param p_src           The first source pixel
+/// @param p_layout        Source offsets of green, red and blue, then the pixel size
+/// @param step            Bytes from one source pixel to the next
+/// @param b_reverse       Write the first pixel to the last LED
+///
+/// @return The number of pixels set, less than count when the palette is full
+static size_t ws2812b_blit_palette(ws2812b_t * const p_instance,
+                                   size_t const led_idx,
+                                   size_t const count,
+                                   uint8_t const * const p_src,
+                                   uint8_t const * const p_layout,
+                                   size_t const step,
+                                   bool const b_reverse)
+{
+    size_t pixel = 0u;
+    bool b_found = true;
+
+    while(b_found && (pixel < count))
+    {
+        uint8_t const * const p_pixel = &p_src[pixel * step];
+        size_t index;
+
+        b_found = ws2812b_palette_find(p_instance,
+                                       p_pixel[p_layout[1]],
+                                       p_pixel[p_layout[0]],
+                                       p_pixel[p_layout[2]],
+                                       &index);
+
+        if(b_found)
+        {
+            ws2812b_set_index(p_instance,
+                              led_idx + (b_reverse ? (count - 1u - pixel) : pixel),
+                              1u,
+                              index);
+            pixel++;
+        }
+    }
+
+    return pixel;
+}
+
+/// Get the stream bytes per LED of a stream format
+///
+/// @param state      The stream format
+/// @param p_encoder  The encoder, only used for WS2812B_INIT_CUSTOM
+///
+/// @return Stream bytes per LED, 0 if the format is not valid
+static size_t ws2812b_bytes_per_led(ws2812b_init_state_t const state,
+                                    ws2812b_encoder_t const * const p_encoder)
+{
+    size_t bytes = 0u;
+
+    if(WS2812B_INIT_2p5MHz == state)
+    {
+        bytes = WS2812_BYTES_PER_LED_2P5MHZ;
+    }
+    else if(WS2812B_INIT_5MHz == state)
+    {
+        bytes = WS2812_BYTES_PER_LED_5MHZ;
+    }
+    else if((WS2812B_INIT_CUSTOM == state) && (NULL != p_encoder))
+    {
+        bytes = WS2812_BYTES_PER_LED_SYMBOL(p_encoder->symbol_bits);
+    }
+    else if(WS2812B_INIT_UART == state)
+    {
+        bytes = WS2812_BYTES_PER_LED_UART;
+    }
+
+    return bytes;
+}
+
+/// Add a span of changed LEDs to the dirty list
+///
+/// Touching or overlapping spans are merged.  When the list is full the
+/// span is merged with its nearest neighbor, so the list only ever grows
+/// to cover a few unchanged LEDs rather than losing changes.
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param start           First changed LED index (0 based)
+/// @param end             One past the last changed LED index
+static void ws2812b_add_dirty(ws2812b_t * const p_instance,
+                              size_t start,
+                              size_t end)
+{
+    ws2812b_data_span_add(p_instance->dirty, &p_instance->dirty_count, start, end);
+    ws2812b_add_tx_dirty(p_instance, start, end);
+}
+
+/// Grow the span of LEDs changed since the last sent frame
+///
+/// @param p_instance      The instance of a ws2912b_t structure (LED string)
+/// @param start           First changed LED index (0 based)
+/// @param end             One past the last changed LED index
+static void ws2812b_add_tx_dirty(ws2812b_t * const p_instance,
+                                 size_t const start,
+                                 size_t const end)
+{
+    ws2812b_span_t * const p_span = &p_instance->tx_dirty;
+
+    if(p_span->start >= p_span->end)
+    {
+        p_span->start = start;
+        p_span->end = end;
+    }
+    else
+    {
+        p_span->start = (start < p_span->start) ? start : p_span->start;
+        p_span->end = (end > p_span->end) ? end : p_span->end;
+    }
+}
+
+/// Build the stream patterns of a color table
+///
+/// @param p_instance      The instance the table is for
+/// @param p_table         The table, settings already filled in
+static void ws2812b_color_build(ws2812b_t const * const p_instance,
+                                ws2812b_color_table_t * const p_table)
+{
+    // Storage order is GRB
+    uint8_t const channel_max[WS2812B_BYTES_PER_LED] =
+        {p_table->green_max, p_table->red_max, p_table->blue_max};
+    size_t const out_bytes =
+        ws2812b_data_stream_bytes_per_led(p_instance) / WS2812B_BYTES_PER_LED;
+
+    for(size_t channel = 0; channel < WS2812B_BYTES_PER_LED; channel++)
+    {
+        uint32_t const scale = (uint32_t)channel_max[channel] * p_table->brightness;
+
+        for(size_t level = 0; level < 256u; level++)
+        {
+            uint32_t const curved = (NULL != p_table->p_gamma) ?
+                p_table->p_gamma[level] : (uint32_t)level;
+            // Rounded divide by 255 * 255
+            uint8_t const out = (uint8_t)(((curved * scale) + 32512u) / 65025u);
+            uint8_t pattern[WS2812B_SYMBOL_BITS_MAX];
+
+            // UART characters don't line up with storage bytes, the
+            // corrected level is kept and encoded with the LED
+            if(WS2812B_INIT_UART == p_instance->init_state)
+            {
+                p_table->stream[channel][level][0] = out;
+            }
+            else
+            {
+                ws2812b_encode_format(p_instance, pattern, &out, 1u);
+                memcpy(p_table->stream[channel][level], pattern, out_bytes);
+            }
+        }
+    }
+}
+
+/// Encode whole LEDs through a color table
+///
+/// @param p_table   The color table
+/// @param p_stream  Where to write the stream bytes
+/// @param p_buffer  The storage bytes (GRB) to encode
+/// @param size      The number of storage bytes to encode, whole LEDs
+/// @param out_bytes Stream bytes per storage byte
+static void ws2812b_encode_color_table(ws2812b_color_table_t const * const p_table,
+                                       uint8_t * const p_stream,
+                                       uint8_t const * const p_buffer,
+                                       size_t const size,
+                                       size_t const out_bytes)
+{
+    uint8_t * p_out = p_stream;
+
+    // Fixed size copies for the built in formats compile to plain moves
+    if(WS2812_STREAM_BYTES_PER_BYTE_2P5MHZ == out_bytes)
+    {
+        for(size_t i = 0; i < size; i += WS2812B_BYTES_PER_LED)
+        {
+            memcpy(&p_out[0u], p_table->stream[0][p_buffer[i]], 3u);
+            memcpy(&p_out[3u], p_table->stream[1][p_buffer[i + 1u]], 3u);
+            memcpy(&p_out[6u], p_table->stream[2][p_buffer[i + 2u]], 3u);
+            p_out += WS2812_BYTES_PER_LED_2P5MHZ;
+        }
+    }
+    else if(WS2812_STREAM_BYTES_PER_BYTE_5MHZ == out_bytes)
+    {
+        for(size_t i = 0; i < size; i += WS2812B_BYTES_PER_LED)
+        {
+            memcpy(&p_out[0u], p_table->stream[0][p_buffer[i]], 6u);
+            memcpy(&p_out[6u], p_table->stream[1][p_buffer[i + 1u]], 6u);
+            memcpy(&p_out[12u], p_table->stream[2][p_buffer[i + 2u]], 6u);
+            p_out += WS2812_BYTES_PER_LED_5MHZ;
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < size; i += WS2812B_BYTES_PER_LED)
+        {
+            memcpy(&p_out[0u], p_table->stream[0][p_buffer[i]], out_bytes);
+            memcpy(&p_out[out_bytes], p_table->stream[1][p_buffer[i + 1u]], out_bytes);
+            memcpy(&p_out[2u * out_bytes], p_table->stream[2][p_buffer[i + 2u]], out_bytes);
+            p_out += WS2812B_BYTES_PER_LED * out_bytes;
+        }
+    }
+}
+
+/// Decode one storage byte from its stream pattern
+///
+/// @param p_decoder    Masks for the stream format
+/// @param p_stream     The symbol_bits stream bytes of the storage byte
+///
+/// @return The storage byte
+static uint8_t ws2812b_decode_byte(ws2812b_decoder_t const * const p_decoder,
+                                   uint8_t const * const p_stream)
+{
+    unsigned const step = p_decoder->symbol_bits - 1u;
+    uint64_t bits = 0u;
+
+    for(unsigned byte = 0; byte < p_decoder->symbol_bits; byte++)
+    {
+        bits = (bits << 8u) | p_stream[byte];
+    }
+
+    // Data bit n is now bit n * symbol_bits, gather them to bit n
+    bits = (bits >> p_decoder->shift) & p_decoder->spread;
+    bits = (bits | (bits >> step)) & p_decoder->pairs;
+    bits = (bits | (bits >> (2u * step))) & p_decoder->nibbles;
+    bits = (bits | (bits >> (4u * step)));
+
+    return (uint8_t)bits;
+}
+
+/// Encode storage bytes into the 2.5Mhz stream format
+///
+/// At 2.5Mhz every storage byte lines up with exactly 3 stream bytes,
+/// so whole blocks go through the vector kernel when there is one and
+/// the rest are converted with a single table lookup per byte.
+///
+/// @param p_stream  Where to write the stream bytes
+/// @param p_buffer  The storage bytes to encode
+/// @param size      The number of storage bytes to encode
+static void ws2812b_encode_2p5mhz(uint8_t * const p_stream,
+                                  uint8_t const * const p_buffer,
+                                  size_t const size)
+{
+    size_t i = 0;
+    ws2812b_simd_kernels_t const * const p_simd = ws2812b_simd_kernels();
+
+    if(NULL != p_simd->encode_2p5mhz)
+    {
+        i = p_simd->encode_2p5mhz(p_stream, p_buffer, size);
+    }
+
+    uint8_t * p_out = &p_stream[i * WS2812_STREAM_BYTES_PER_BYTE_2P5MHZ];
+
+    for (; i < size; i++)
+    {
+        uint8_t const * const p_pattern = ws2812b_lut_2p5mhz[p_buffer[i]];
+
+        p_out[0] = p_pattern[0];
+        p_out[1] = p_pattern[1];
+        p_out[2] = p_pattern[2];
+        p_out += WS2812_STREAM_BYTES_PER_BYTE_2P5MHZ;
+    }
+}
+
+/// Encode storage bytes into the 5Mhz stream format
+///
+/// Each storage byte is built as one 48 bit word from two nibble lookups
+/// and written out as 6 stream bytes, or 2 bytes at a time as a 64 and a
+/// 32 bit store with WS2812B_WORD_STORES.  Whole blocks go through the
+/// vector kernel when there is one.
+///
+/// @param p_stream  Where to write the stream bytes
+/// @param p_buffer  The storage bytes to encode
+/// @param size      The number of storage bytes to encode
+static void ws2812b_encode_5mhz(uint8_t * const p_stream,
+                                uint8_t const * const p_buffer,
+                                size_t const size)
+{
+    size_t i = 0;
+    ws2812b_simd_kernels_t const * const p_simd = ws2812b_simd_kernels();
+
+    if(NULL != p_simd->encode_5mhz)
+    {
+        i = p_simd->encode_5mhz(p_stream, p_buffer, size);
+    }
+
+    uint8_t * p_out = &p_stream[i * WS2812_STREAM_BYTES_PER_BYTE_5MHZ];
+
+#if defined(WS2812B_WORD_STORES)
+    for (; (i + 2u) <= size; i += 2u)
+    {
+        uint64_t const first =
+            ((uint64_t)ws2812b_lut_5mhz[p_buffer[i] >> 4u] << 24u) |
+            ws2812b_lut_5mhz[p_buffer[i] & 0x0Fu];
+        uint64_t const second =
+            ((uint64_t)ws2812b_lut_5mhz[p_buffer[i + 1u] >> 4u] << 24u) |
+            ws2812b_lut_5mhz[p_buffer[i + 1u] & 0x0Fu];
+        // Both patterns, 96 stream bits, MSB first in the stream
+        uint64_t high = (first << 16u) | (second >> 32u);
+        uint32_t low = (uint32_t)second;
+
+#if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        high = __builtin_bswap64(high);
+        low = __builtin_bswap32(low);
+#endif
+        memcpy(&p_out[0u], &high, sizeof(high));
+        memcpy(&p_out[8u], &low, sizeof(low));
+        p_out += 2u * WS2812_STREAM_BYTES_PER_BYTE_5MHZ;
+    }
+#endif
+
+    for (; i < size; i++)
+    {
+        uint64_t const pattern =
+            ((uint64_t)ws2812b_lut_5mhz[p_buffer[i] >> 4u] << 24u) |
+            ws2812b_lut_5mhz[p_buffer[i] & 0x0Fu];
+
+        p_out[0] = (uint8_t)(pattern >> 40u);
+        p_out[1] = (uint8_t)(pattern >> 32u);
+        p_out[2] = (uint8_t)(pattern >> 24u);
+        p_out[3] = (uint8_t)(pattern >> 16u);
+        p_out[4] = (uint8_t)(pattern >> 8u);
+        p_out[5] = (uint8_t)pattern;
+        p_out += WS2812_STREAM_BYTES_PER_BYTE_5MHZ;
+    }
+}
+
+/// Encode whole LEDs into the UART stream format
+///
+/// The 24 bits of a LED are 4 lookups of 6 bits, each giving 2 characters.
+///
+/// @param p_table   Color table holding corrected levels, NULL for none
+/// @param p_stream  Where to write the stream bytes
+/// @param p_buffer  The storage bytes (GRB) to encode
+/// @param size      The number of storage bytes to encode, whole LEDs
+static void ws2812b_encode_uart(ws2812b_color_table_t const * const p_table,
+                                uint8_t * const p_stream,
+                                uint8_t const * const p_buffer,
+                                size_t const size)
+{
+    uint8_t * p_out = p_stream;
+
+    for(size_t i = 0; i < size; i += WS2812B_BYTES_PER_LED)
+    {
+        uint32_t bits;
+
+        // The whole LED is read first, in place its characters overwrite it
+        if(NULL != p_table)
+        {
+            bits = ((uint32_t)p_table->stream[0][p_buffer[i]][0] << 16u) |
+                   ((uint32_t)p_table->stream[1][p_buffer[i + 1u]][0] << 8u) |
+                   p_table->stream[2][p_buffer[i + 2u]][0];
+        }
+        else
+        {
+            bits = ((uint32_t)p_buffer[i] << 16u) |
+                   ((uint32_t)p_buffer[i + 1u] << 8u) |
+                   p_buffer[i + 2u];
+        }
+
+        memcpy(&p_out[0u], ws2812b_lut_uart[(bits >> 18u) & 0x3Fu], 2u);
+        memcpy(&p_out[2u], ws2812b_lut_uart[(bits >> 12u) & 0x3Fu], 2u);
+        memcpy(&p_out[4u], ws2812b_lut_uart[(bits >> 6u) & 0x3Fu], 2u);
+        memcpy(&p_out[6u], ws2812b_lut_uart[bits & 0x3Fu], 2u);
+        p_out += WS2812_BYTES_PER_LED_UART;
+    }
+}
+
+/// Encode storage bytes into a custom stream format
+///
+/// A storage byte expands to exactly symbol_bits stream bytes.  It is built
+/// as one word from two nibble lookups and written out MSB first.
+///
+/// @param p_encoder The custom stream format
+/// @param p_stream  Where to write the stream bytes
+/// @param p_buffer  The storage bytes to encode
+/// @param size      The number of storage bytes to encode
+static void ws2812b_encode_custom(ws2812b_encoder_t const * const p_encoder,
+                                  uint8_t * const p_stream,
+                                  uint8_t const * const p_buffer,
+                                  size_t const size)
+{
+    uint32_t const * const lut = p_encoder->lut;
+    unsigned const nibble_bits = 4u * p_encoder->symbol_bits;
+    unsigned const out_bytes = p_encoder->symbol_bits;
+    uint8_t * p_out = p_stream;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        uint64_t const pattern =
+            ((uint64_t)lut[p_buffer[i] >> 4u] << nibble_bits) |
+            lut[p_buffer[i] & 0x0Fu];
+
+        for(unsigned byte = 0; byte < out_bytes; byte++)
+        {
+            p_out[byte] = (uint8_t)(pattern >> (8u * (out_bytes - 1u - byte)));
+        }
+
+        p_out += out_bytes;
+    }
 }
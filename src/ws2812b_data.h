@@ -22,6 +22,44 @@
 #define WS2812_BYTES_PER_LED_2P5MHZ (WS2812_BITS_PER_LED_2P5MHZ / 8u)
 /// Bytes per LED for stream buffer running at 5MHz
 #define WS2812_BYTES_PER_LED_5MHZ (WS2812_BITS_PER_LED_5MHZ / 8u)
+/// Most stream bits per data bit a custom encoder supports
+#define WS2812B_SYMBOL_BITS_MAX 8u
+/// Bytes per LED for a custom stream with symbol_bits stream bits per data bit
+#define WS2812_BYTES_PER_LED_SYMBOL(symbol_bits) (WS2812B_BYTES_PER_LED * (symbol_bits))
+/// Bytes per LED for stream buffer running at 3.2Mhz (4 bits per symbol)
+#define WS2812_BYTES_PER_LED_3P2MHZ WS2812_BYTES_PER_LED_SYMBOL(4u)
+/// Bytes per LED for stream buffer running at 6.4Mhz (8 bits per symbol)
+#define WS2812_BYTES_PER_LED_6P4MHZ WS2812_BYTES_PER_LED_SYMBOL(8u)
+/// Data bits per UART character, 7N1 at 2.5Mbaud with inverted TX
+#define WS2812_BITS_PER_CHAR_UART 3u
+/// Bytes (UART characters) per LED for stream buffer sent by a UART
+#define WS2812_BYTES_PER_LED_UART (WS2812B_BITS_PER_LED / WS2812_BITS_PER_CHAR_UART)
+/// Largest stream pattern of a single LED, used to size ws2812b_data_encode_color buffers
+#define WS2812B_LED_PATTERN_MAX WS2812_BYTES_PER_LED_SYMBOL(WS2812B_SYMBOL_BITS_MAX)
+
+/// Symbols for ws2812b_encoder_init at 3.2Mhz (312ns per stream bit)
+/// 0 = 1000 (0.31us high), 1 = 1110 (0.94us high)
+#define WS2812B_SYMBOLS_3P2MHZ 4u, 0x8u, 0xEu
+/// Symbols for ws2812b_encoder_init at 6.4Mhz (156ns per stream bit)
+/// 0 = 11100000 (0.47us high), 1 = 11111000 (0.78us high)
+#define WS2812B_SYMBOLS_6P4MHZ 8u, 0xE0u, 0xF8u
+
+/// LEDs dithered into the storage buffer and encoded per block in 16 bit mode
+#define WS2812B_DITHER_BLOCK_LEDS 64u
+
+/// Equal LEDs in a row encoded once and copied when ws2812b_t::b_encode_runs is set,
+/// shorter runs are encoded as usual.  Lower it where the encoder is slow (no SIMD).
+#ifndef WS2812B_RUN_LEDS_MIN
+#define WS2812B_RUN_LEDS_MIN 16u
+#endif
+
+/// Most colors of a palette (8 bit indices)
+#define WS2812B_PALETTE_MAX 256u
+/// Storage buffer bytes for led_count LEDs with index_bits (8 or 4) bit palette indices
+#define WS2812B_PALETTE_BUFFER_SZ(led_count, index_bits) ((((led_count) * (index_bits)) + 7u) / 8u)
+
+/// How many separate dirty LED spans an instance tracks before merging them
+#define WS2812B_DIRTY_SPAN_MAX 4u
 
 
 typedef enum
@@ -29,29 +67,175 @@ typedef enum
   WS2812B_INIT_FAILED,  ///< WS2812B_INIT_FAILED
   WS2812B_INIT_2p5MHz,  ///< WS2812B_INIT_2p5MHz
   WS2812B_INIT_5MHz,    ///< WS2812B_INIT_5MHz
+  WS2812B_INIT_CUSTOM,  ///< WS2812B_INIT_CUSTOM, see ws2812b_data_init_custom
+  WS2812B_INIT_UART,    ///< WS2812B_INIT_UART, 2.5Mbaud 7N1 with inverted TX
 }ws2812b_init_state_t;
 
+/// What ws2812b_data_tx_prepare found changed since the last ws2812b_data_tx_commit
+typedef enum
+{
+  WS2812B_TX_NONE,      ///< Nothing changed, the strip already shows the frame
+  WS2812B_TX_PARTIAL,   ///< Only a prefix of the stream changed
+  WS2812B_TX_FULL,      ///< The last LED changed, send the full stream
+}ws2812b_tx_t;
+
+/// Channel order and size of the source pixels of ws2812b_data_blit
+typedef enum
+{
+  WS2812B_PIXEL_RGB,    ///< 3 bytes, red green blue
+  WS2812B_PIXEL_RGBA,   ///< 4 bytes, red green blue and an ignored alpha
+  WS2812B_PIXEL_GRB,    ///< 3 bytes, the storage order
+  WS2812B_PIXEL_BGR,    ///< 3 bytes, blue green red
+  WS2812B_PIXEL_BGRA,   ///< 4 bytes, blue green red and an ignored alpha
+}ws2812b_pixel_format_t;
+
+/// Bytes per source pixel of a ws2812b_pixel_format_t
+#define WS2812B_PIXEL_SIZE(format) \
+    ((((format) == WS2812B_PIXEL_RGBA) || ((format) == WS2812B_PIXEL_BGRA)) ? 4u : 3u)
+
+/// This struct holds a custom stream format
+///
+/// Every data bit is sent as a symbol of symbol_bits stream bits, MSB first.
+/// Built by ws2812b_encoder_init, can be shared by many instances.
+typedef struct
+{
+    uint8_t  symbol_bits;               ///< Stream bits per data bit, 1 to WS2812B_SYMBOL_BITS_MAX
+    uint8_t  symbol_0;                  ///< Symbol sent for a 0 bit
+    uint8_t  symbol_1;                  ///< Symbol sent for a 1 bit
+    uint32_t lut[16];                   ///< Stream bits for each nibble, built once at init
+}
+ws2812b_encoder_t;
+
+/// This struct holds a color correction folded into the stream encoding
+///
+/// Built by ws2812b_data_color_init in app storage.  Each storage byte is
+/// mapped through the gamma curve, scaled by its channel's white balance
+/// and the brightness, and the stream pattern of the result is kept, so
+/// encoding stays one table lookup per byte.
+///
+/// A WS2812B_INIT_UART strip can't use patterns, its characters span
+/// storage bytes.  For it stream[channel][level][0] holds the corrected
+/// level instead, and the rest of the entry is unused.
+typedef struct
+{
+    uint8_t const * p_gamma;            ///< 256 entry curve, NULL for linear (e.g. ws2812b_gamma_2p2)
+    uint8_t         red_max;            ///< Red level at full brightness (white balance)
+    uint8_t         green_max;          ///< Green level at full brightness (white balance)
+    uint8_t         blue_max;           ///< Blue level at full brightness (white balance)
+    uint8_t         brightness;         ///< Global brightness, 255 = full
+    uint8_t         stream[WS2812B_BYTES_PER_LED][256][WS2812B_SYMBOL_BITS_MAX]; ///< Pattern per channel (GRB) and level, the corrected level for UART
+}
+ws2812b_color_table_t;
+
+/// This struct holds the colors of an instance that stores palette indices
+///
+/// The storage buffer then holds an index per LED instead of its color and
+/// the stream pattern of every color is kept, so encoding a LED is a copy.
+/// Set colors with ws2812b_data_palette_set, the set functions also add
+/// colors they don't find while there is room.
+typedef struct
+{
+    uint8_t * p_colors;                 ///< size entries of 3 bytes (GRB)
+    uint8_t * p_patterns;               ///< size entries of stream bytes per LED, built by the data module
+    size_t    patterns_sz;              ///< The size of p_patterns
+    size_t    size;                     ///< Entries there is room for, up to 2^index_bits
+    size_t    count;                    ///< Entries in use
+    uint8_t   index_bits;               ///< 8 or 4 bits per LED in the storage buffer
+}
+ws2812b_palette_t;
+
+/// A range of LEDs, by 0 based index
+typedef struct
+{
+    size_t start;                       ///< First LED index in the span
+    size_t end;                         ///< One past the last LED index in the span
+}
+ws2812b_span_t;
+
 /// This struct holds instances of ws2812b strips
+///
+/// ws2812b_data_init reads the optional fields (p_encoder, p_shadow,
+/// p_color, p_buffer16, p_palette...), so an instance must start out zeroed
+/// before the app fills in what it uses.  Static instances already are, on
+/// the stack use WS2812B_INSTANCE_INIT or memset.
 typedef struct
 {
     uint8_t *            p_buffer;      ///< The buffer storage area for the LED strip data
     size_t               buffer_sz;     ///< The size led store p_buffer
-    uint8_t *            p_stream;      ///< The buffer that streams data over SPI
+    uint8_t *            p_stream;      ///< The buffer that streams data over SPI (NULL if only chunked)
     size_t               stream_sz;     ///< The size of the stream buffer
     size_t               led_count;     ///< The number of LED's on the strip
     ws2812b_init_state_t init_state;    ///< Tracks if an instance is properly initialized
+    ws2812b_encoder_t const * p_encoder; ///< Stream format when init_state is WS2812B_INIT_CUSTOM
+    ws2812b_span_t       dirty[WS2812B_DIRTY_SPAN_MAX]; ///< LEDs changed since the last stream update
+    size_t               dirty_count;   ///< The number of valid entries in dirty
+    uint8_t *            p_shadow;      ///< Optional copy of the last sent stream (NULL for none)
+    size_t               shadow_sz;     ///< The size of the shadow buffer
+    ws2812b_span_t       tx_dirty;      ///< LEDs changed since the last ws2812b_data_tx_commit
+    size_t               tx_len;        ///< Stream bytes given by the last ws2812b_data_tx_prepare
+    bool                 b_shadow_valid; ///< The shadow holds the frame on the strip
+    ws2812b_color_table_t * p_color;    ///< Color correction applied while encoding (NULL for none)
+    uint16_t *           p_buffer16;    ///< Optional 16 bit per channel storage (GRB), NULL for none
+    size_t               buffer16_sz;   ///< The size of p_buffer16 in bytes
+    uint8_t *            p_dither;      ///< Dither error per channel, needed with p_buffer16
+    size_t               dither_sz;     ///< The size of p_dither
+    ws2812b_palette_t *  p_palette;     ///< Palette when p_buffer holds color indices (NULL for GRB)
+    bool                 b_in_place;    ///< p_buffer is the tail of p_stream, see ws2812b_data_init_in_place
+    bool                 b_encoded;     ///< In place storage is encoded into p_stream until ws2812b_data_restore
+    bool                 b_encode_runs; ///< Encode runs of equal LEDs once and copy the pattern (mostly dark or solid frames)
 }
 ws2812b_t;
 
+/// Initializer for a ws2812b_t with its buffers, every optional field unused
+#define WS2812B_INSTANCE_INIT(p_buf, buf_sz, p_strm, strm_sz, leds) \
+    { .p_buffer = (p_buf), .buffer_sz = (buf_sz), .p_stream = (p_strm), \
+      .stream_sz = (strm_sz), .led_count = (leds) }
+
+
+/// Gamma 2.2 curve for ws2812b_color_table_t::p_gamma
+extern uint8_t const ws2812b_gamma_2p2[256];
+
 
 bool ws2812b_data_init(ws2812b_t * const p_instance,
                        ws2812b_init_state_t const desired_spi_clk);
+bool ws2812b_data_init_in_place(ws2812b_t * const p_instance,
+                                ws2812b_init_state_t const desired_spi_clk);
+bool ws2812b_data_restore(ws2812b_t * const p_instance);
+bool ws2812b_encoder_init(ws2812b_encoder_t * const p_encoder,
+                          uint8_t const symbol_bits,
+                          uint8_t const symbol_0,
+                          uint8_t const symbol_1);
+bool ws2812b_data_init_custom(ws2812b_t * const p_instance,
+                              ws2812b_encoder_t const * const p_encoder);
+bool ws2812b_data_color_init(ws2812b_t * const p_instance,
+                             ws2812b_color_table_t * const p_table,
+                             uint8_t const * const p_gamma,
+                             uint8_t const red_max,
+                             uint8_t const green_max,
+                             uint8_t const blue_max);
+bool ws2812b_data_set_brightness(ws2812b_t * const p_instance,
+                                 uint8_t const brightness);
 bool ws2812b_data_set_x(ws2812b_t * const p_instance,
                         size_t const led_num_start,
                         size_t const led_num_to_set,
                         uint8_t const red,
                         uint8_t const green,
                         uint8_t const blue);
+bool ws2812b_data_set16_x(ws2812b_t * const p_instance,
+                          size_t const led_num_start,
+                          size_t const led_num_to_set,
+                          uint16_t const red,
+                          uint16_t const green,
+                          uint16_t const blue);
+bool ws2812b_data_palette_set(ws2812b_t * const p_instance,
+                              size_t const index,
+                              uint8_t const red,
+                              uint8_t const green,
+                              uint8_t const blue);
+bool ws2812b_data_set_index_x(ws2812b_t * const p_instance,
+                              size_t const led_num_start,
+                              size_t const led_num_to_set,
+                              size_t const index);
 bool ws2812b_data_set(ws2812b_t * const p_instance,
                       size_t const led_num,
                       uint8_t const red,
@@ -62,7 +246,51 @@ bool ws2812b_data_set_all(ws2812b_t * const p_instance,
                           uint8_t const green,
                           uint8_t const blue);
 bool ws2812b_data_clear_all(ws2812b_t * const p_instance);
+bool ws2812b_data_blit(ws2812b_t * const p_instance,
+                       size_t const led_num_start,
+                       size_t const led_num_count,
+                       uint8_t const * const p_pixels,
+                       ws2812b_pixel_format_t const format,
+                       size_t const stride,
+                       bool const b_reverse);
+bool ws2812b_data_scatter(ws2812b_t * const p_instance,
+                          size_t const * const p_leds,
+                          size_t const count,
+                          uint8_t const * const p_pixels,
+                          ws2812b_pixel_format_t const format,
+                          size_t const stride);
+void ws2812b_data_mark_dirty(ws2812b_t * const p_instance,
+                             size_t const led_num_start,
+                             size_t const led_num_count);
+void ws2812b_data_mark_dirty_all(ws2812b_t * const p_instance);
+bool ws2812b_data_is_dirty(ws2812b_t const * const p_instance);
+void ws2812b_data_span_add(ws2812b_span_t * const p_spans,
+                           size_t * const p_count,
+                           size_t start,
+                           size_t end);
+size_t ws2812b_data_stream_bytes_per_led(ws2812b_t const * const p_instance);
+bool ws2812b_data_encode(ws2812b_t const * const p_instance,
+                         uint8_t * const p_dst,
+                         size_t const led_num_start,
+                         size_t const led_num_count);
+bool ws2812b_data_dither(ws2812b_t * const p_instance,
+                         size_t const led_num_start,
+                         size_t const led_num_count);
+bool ws2812b_data_encode_color(ws2812b_t const * const p_instance,
+                               uint8_t const red,
+                               uint8_t const green,
+                               uint8_t const blue,
+                               uint8_t * const p_pattern);
+bool ws2812b_data_stream_fill(ws2812b_t * const p_instance,
+                              size_t const led_num_start,
+                              size_t const led_num_to_set,
+                              uint8_t const * const p_pattern);
+ws2812b_tx_t ws2812b_data_tx_prepare(ws2812b_t * const p_instance,
+                                     size_t * const p_stream_len);
+void ws2812b_data_tx_commit(ws2812b_t * const p_instance);
+void ws2812b_update_stream(ws2812b_t * const p_instance);
 void ws2812b_update_stream_2p5mhz(ws2812b_t * const p_instance);
 void ws2812b_update_stream_5mhz(ws2812b_t * const p_instance);
+void ws2812b_update_stream_uart(ws2812b_t * const p_instance);
 
 #endif /* WS2812B_DATA_H_ */
@@ -0,0 +1,865 @@
+/// ws2812b_data_simd
+///
+/// Vectorized bulk encode kernels used by ws2812b_data to build the SPI stream
+///
+/// Every storage byte is split into nibbles and each nibble is looked up in
+/// 16 entry tables with a byte shuffle.  The per stream byte results are then
+/// interleaved back into wire order.  The kernels are compiled with function
+/// level target attributes and picked at runtime, so the module builds with
+/// the default compiler flags.  Define WS2812B_NO_SIMD to leave only the
+/// portable C encoder (the default on anything that is not x86 or AArch64).
+
+#include "ws2812b_data_simd.h"
+
+#include <string.h>
+
+#if !defined(WS2812B_NO_SIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define WS2812B_SIMD_X86
+#include <immintrin.h>
+#elif !defined(WS2812B_NO_SIMD) && defined(__aarch64__) && \
+      defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+#define WS2812B_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+
+#if defined(WS2812B_SIMD_X86) || defined(WS2812B_SIMD_NEON)
+
+/// 2.5Mhz nibble lookups.  A byte expands to 24 bits, the high nibble owns
+/// stream byte 0 and the top of byte 1, the low nibble the rest.
+static uint8_t const ws2812b_simd_2p5mhz_b0[16] =
+    {0x92, 0x92, 0x93, 0x93, 0x9A, 0x9A, 0x9B, 0x9B, 0xD2, 0xD2, 0xD3, 0xD3, 0xDA, 0xDA, 0xDB, 0xDB};
+static uint8_t const ws2812b_simd_2p5mhz_b1_hi[16] =
+    {0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60, 0x40, 0x60};
+static uint8_t const ws2812b_simd_2p5mhz_b1_lo[16] =
+    {0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D};
+static uint8_t const ws2812b_simd_2p5mhz_b2[16] =
+    {0x24, 0x26, 0x34, 0x36, 0xA4, 0xA6, 0xB4, 0xB6, 0x24, 0x26, 0x34, 0x36, 0xA4, 0xA6, 0xB4, 0xB6};
+
+/// 5Mhz nibble lookups.  A nibble expands to exactly 3 stream bytes.
+static uint8_t const ws2812b_simd_5mhz_q0[16] =
+    {0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xF3, 0xF3, 0xF3, 0xF3, 0xF3, 0xF3, 0xF3, 0xF3};
+static uint8_t const ws2812b_simd_5mhz_q1[16] =
+    {0x0C, 0x0C, 0x0F, 0x0F, 0xCC, 0xCC, 0xCF, 0xCF, 0x0C, 0x0C, 0x0F, 0x0F, 0xCC, 0xCC, 0xCF, 0xCF};
+static uint8_t const ws2812b_simd_5mhz_q2[16] =
+    {0x30, 0x3C, 0x30, 0x3C, 0x30, 0x3C, 0x30, 0x3C, 0x30, 0x3C, 0x30, 0x3C, 0x30, 0x3C, 0x30, 0x3C};
+
+#endif
+
+
+#if defined(WS2812B_SIMD_X86)
+
+/// Shuffle masks that interleave 3 registers of bytes (or 16 bit words)
+/// into 3 registers in wire order.  Indexed [output register][input register].
+static int8_t const ws2812b_simd_ilv3_epi8[3][3][16] =
+{
+    {
+        {  0,  -1,  -1,   1,  -1,  -1,   2,  -1,  -1,   3,  -1,  -1,   4,  -1,  -1,   5},
+        { -1,   0,  -1,  -1,   1,  -1,  -1,   2,  -1,  -1,   3,  -1,  -1,   4,  -1,  -1},
+        { -1,  -1,   0,  -1,  -1,   1,  -1,  -1,   2,  -1,  -1,   3,  -1,  -1,   4,  -1},
+    },
+    {
+        { -1,  -1,   6,  -1,  -1,   7,  -1,  -1,   8,  -1,  -1,   9,  -1,  -1,  10,  -1},
+        {  5,  -1,  -1,   6,  -1,  -1,   7,  -1,  -1,   8,  -1,  -1,   9,  -1,  -1,  10},
+        { -1,   5,  -1,  -1,   6,  -1,  -1,   7,  -1,  -1,   8,  -1,  -1,   9,  -1,  -1},
+    },
+    {
+        { -1,  11,  -1,  -1,  12,  -1,  -1,  13,  -1,  -1,  14,  -1,  -1,  15,  -1,  -1},
+        { -1,  -1,  11,  -1,  -1,  12,  -1,  -1,  13,  -1,  -1,  14,  -1,  -1,  15,  -1},
+        { 10,  -1,  -1,  11,  -1,  -1,  12,  -1,  -1,  13,  -1,  -1,  14,  -1,  -1,  15},
+    },
+};
+
+static int8_t const ws2812b_simd_ilv3_epi16[3][3][16] =
+{
+    {
+        {  0,   1,  -1,  -1,  -1,  -1,   2,   3,  -1,  -1,  -1,  -1,   4,   5,  -1,  -1},
+        { -1,  -1,   0,   1,  -1,  -1,  -1,  -1,   2,   3,  -1,  -1,  -1,  -1,   4,   5},
+        { -1,  -1,  -1,  -1,   0,   1,  -1,  -1,  -1,  -1,   2,   3,  -1,  -1,  -1,  -1},
+    },
+    {
+        { -1,  -1,   6,   7,  -1,  -1,  -1,  -1,   8,   9,  -1,  -1,  -1,  -1,  10,  11},
+        { -1,  -1,  -1,  -1,   6,   7,  -1,  -1,  -1,  -1,   8,   9,  -1,  -1,  -1,  -1},
+        {  4,   5,  -1,  -1,  -1,  -1,   6,   7,  -1,  -1,  -1,  -1,   8,   9,  -1,  -1},
+    },
+    {
+        { -1,  -1,  -1,  -1,  12,  13,  -1,  -1,  -1,  -1,  14,  15,  -1,  -1,  -1,  -1},
+        { 10,  11,  -1,  -1,  -1,  -1,  12,  13,  -1,  -1,  -1,  -1,  14,  15,  -1,  -1},
+        { -1,  -1,  10,  11,  -1,  -1,  -1,  -1,  12,  13,  -1,  -1,  -1,  -1,  14,  15},
+    },
+};
+
+
+#define WS2812B_SIMD_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define WS2812B_SIMD_TARGET_AVX2  __attribute__((target("avx2")))
+
+/// Interleave 3 registers with the selected mask set (SSSE3)
+WS2812B_SIMD_TARGET_SSSE3
+static inline void ws2812b_simd_ilv3_sse(int8_t const (* const p_masks)[3][16],
+                                         __m128i const a,
+                                         __m128i const b,
+                                         __m128i const c,
+                                         __m128i * const p_out)
+{
+    for(int r = 0; r < 3; r++)
+    {
+        __m128i const m0 = _mm_loadu_si128((__m128i const *)p_masks[r][0]);
+        __m128i const m1 = _mm_loadu_si128((__m128i const *)p_masks[r][1]);
+        __m128i const m2 = _mm_loadu_si128((__m128i const *)p_masks[r][2]);
+
+        p_out[r] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m0),
+                                             _mm_shuffle_epi8(b, m1)),
+                                _mm_shuffle_epi8(c, m2));
+    }
+}
+
+/// 2.5Mhz kernel, 16 storage bytes per iteration (SSSE3)
+WS2812B_SIMD_TARGET_SSSE3
+static size_t ws2812b_simd_2p5mhz_ssse3(uint8_t * const p_stream,
+                                        uint8_t const * const p_buffer,
+                                        size_t const size)
+{
+    __m128i const t_b0 = _mm_loadu_si128((__m128i const *)ws2812b_simd_2p5mhz_b0);
+    __m128i const t_b1h = _mm_loadu_si128((__m128i const *)ws2812b_simd_2p5mhz_b1_hi);
+    __m128i const t_b1l = _mm_loadu_si128((__m128i const *)ws2812b_simd_2p5mhz_b1_lo);
+    __m128i const t_b2 = _mm_loadu_si128((__m128i const *)ws2812b_simd_2p5mhz_b2);
+    __m128i const nibble = _mm_set1_epi8(0x0F);
+
+    size_t const blocks = size & ~(size_t)15u;
+    uint8_t * p_out = p_stream;
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        __m128i const x = _mm_loadu_si128((__m128i const *)&p_buffer[i]);
+        __m128i const lo = _mm_and_si128(x, nibble);
+        __m128i const hi = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+
+        __m128i const b0 = _mm_shuffle_epi8(t_b0, hi);
+        __m128i const b1 = _mm_or_si128(_mm_shuffle_epi8(t_b1h, hi),
+                                        _mm_shuffle_epi8(t_b1l, lo));
+        __m128i const b2 = _mm_shuffle_epi8(t_b2, lo);
+
+        __m128i out[3];
+        ws2812b_simd_ilv3_sse(ws2812b_simd_ilv3_epi8, b0, b1, b2, out);
+
+        _mm_storeu_si128((__m128i *)&p_out[0], out[0]);
+        _mm_storeu_si128((__m128i *)&p_out[16], out[1]);
+        _mm_storeu_si128((__m128i *)&p_out[32], out[2]);
+        p_out += 48u;
+    }
+
+    return blocks;
+}
+
+/// 5Mhz kernel, 16 storage bytes per iteration (SSSE3)
+///
+/// The 6 stream bytes of a storage byte are paired into 16 bit words so the
+/// same 3 way interleave used at 2.5Mhz puts them in wire order.
+WS2812B_SIMD_TARGET_SSSE3
+static size_t ws2812b_simd_5mhz_ssse3(uint8_t * const p_stream,
+                                      uint8_t const * const p_buffer,
+                                      size_t const size)
+{
+    __m128i const t_q0 = _mm_loadu_si128((__m128i const *)ws2812b_simd_5mhz_q0);
+    __m128i const t_q1 = _mm_loadu_si128((__m128i const *)ws2812b_simd_5mhz_q1);
+    __m128i const t_q2 = _mm_loadu_si128((__m128i const *)ws2812b_simd_5mhz_q2);
+    __m128i const nibble = _mm_set1_epi8(0x0F);
+
+    size_t const blocks = size & ~(size_t)15u;
+    uint8_t * p_out = p_stream;
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        __m128i const x = _mm_loadu_si128((__m128i const *)&p_buffer[i]);
+        __m128i const lo = _mm_and_si128(x, nibble);
+        __m128i const hi = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+
+        __m128i const c0 = _mm_shuffle_epi8(t_q0, hi);
+        __m128i const c1 = _mm_shuffle_epi8(t_q1, hi);
+        __m128i const c2 = _mm_shuffle_epi8(t_q2, hi);
+        __m128i const c3 = _mm_shuffle_epi8(t_q0, lo);
+        __m128i const c4 = _mm_shuffle_epi8(t_q1, lo);
+        __m128i const c5 = _mm_shuffle_epi8(t_q2, lo);
+
+        __m128i out[3];
+        ws2812b_simd_ilv3_sse(ws2812b_simd_ilv3_epi16,
+                              _mm_unpacklo_epi8(c0, c1),
+                              _mm_unpacklo_epi8(c2, c3),
+                              _mm_unpacklo_epi8(c4, c5),
+                              out);
+
+        _mm_storeu_si128((__m128i *)&p_out[0], out[0]);
+        _mm_storeu_si128((__m128i *)&p_out[16], out[1]);
+        _mm_storeu_si128((__m128i *)&p_out[32], out[2]);
+
+        ws2812b_simd_ilv3_sse(ws2812b_simd_ilv3_epi16,
+                              _mm_unpackhi_epi8(c0, c1),
+                              _mm_unpackhi_epi8(c2, c3),
+                              _mm_unpackhi_epi8(c4, c5),
+                              out);
+
+        _mm_storeu_si128((__m128i *)&p_out[48], out[0]);
+        _mm_storeu_si128((__m128i *)&p_out[64], out[1]);
+        _mm_storeu_si128((__m128i *)&p_out[80], out[2]);
+        p_out += 96u;
+    }
+
+    return blocks;
+}
+
+/// Broadcast a 16 byte table or mask to both 128 bit lanes (AVX2)
+WS2812B_SIMD_TARGET_AVX2
+static inline __m256i ws2812b_simd_bcast(void const * const p_src)
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const *)p_src));
+}
+
+/// Interleave 3 registers with the selected mask set, per 128 bit lane (AVX2)
+WS2812B_SIMD_TARGET_AVX2
+static inline void ws2812b_simd_ilv3_avx(int8_t const (* const p_masks)[3][16],
+                                         __m256i const a,
+                                         __m256i const b,
+                                         __m256i const c,
+                                         __m256i * const p_out)
+{
+    for(int r = 0; r < 3; r++)
+    {
+        p_out[r] = _mm256_or_si256(
+                       _mm256_or_si256(_mm256_shuffle_epi8(a, ws2812b_simd_bcast(p_masks[r][0])),
+                                       _mm256_shuffle_epi8(b, ws2812b_simd_bcast(p_masks[r][1]))),
+                       _mm256_shuffle_epi8(c, ws2812b_simd_bcast(p_masks[r][2])));
+    }
+}
+
+/// 2.5Mhz kernel, 32 storage bytes per iteration (AVX2)
+///
+/// Each 128 bit lane produces the 48 stream bytes for its 16 storage bytes,
+/// the lane halves are then stitched back into order before storing.
+WS2812B_SIMD_TARGET_AVX2
+static size_t ws2812b_simd_2p5mhz_avx2(uint8_t * const p_stream,
+                                       uint8_t const * const p_buffer,
+                                       size_t const size)
+{
+    __m256i const t_b0 = ws2812b_simd_bcast(ws2812b_simd_2p5mhz_b0);
+    __m256i const t_b1h = ws2812b_simd_bcast(ws2812b_simd_2p5mhz_b1_hi);
+    __m256i const t_b1l = ws2812b_simd_bcast(ws2812b_simd_2p5mhz_b1_lo);
+    __m256i const t_b2 = ws2812b_simd_bcast(ws2812b_simd_2p5mhz_b2);
+    __m256i const nibble = _mm256_set1_epi8(0x0F);
+
+    size_t const blocks = size & ~(size_t)31u;
+    uint8_t * p_out = p_stream;
+
+    for(size_t i = 0; i < blocks; i += 32u)
+    {
+        __m256i const x = _mm256_loadu_si256((__m256i const *)&p_buffer[i]);
+        __m256i const lo = _mm256_and_si256(x, nibble);
+        __m256i const hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+
+        __m256i const b0 = _mm256_shuffle_epi8(t_b0, hi);
+        __m256i const b1 = _mm256_or_si256(_mm256_shuffle_epi8(t_b1h, hi),
+                                           _mm256_shuffle_epi8(t_b1l, lo));
+        __m256i const b2 = _mm256_shuffle_epi8(t_b2, lo);
+
+        __m256i o[3];
+        ws2812b_simd_ilv3_avx(ws2812b_simd_ilv3_epi8, b0, b1, b2, o);
+
+        _mm256_storeu_si256((__m256i *)&p_out[0], _mm256_permute2x128_si256(o[0], o[1], 0x20));
+        _mm256_storeu_si256((__m256i *)&p_out[32], _mm256_permute2x128_si256(o[2], o[0], 0x30));
+        _mm256_storeu_si256((__m256i *)&p_out[64], _mm256_permute2x128_si256(o[1], o[2], 0x31));
+        p_out += 96u;
+    }
+
+    return blocks;
+}
+
+/// 5Mhz kernel, 32 storage bytes per iteration (AVX2)
+WS2812B_SIMD_TARGET_AVX2
+static size_t ws2812b_simd_5mhz_avx2(uint8_t * const p_stream,
+                                     uint8_t const * const p_buffer,
+                                     size_t const size)
+{
+    __m256i const t_q0 = ws2812b_simd_bcast(ws2812b_simd_5mhz_q0);
+    __m256i const t_q1 = ws2812b_simd_bcast(ws2812b_simd_5mhz_q1);
+    __m256i const t_q2 = ws2812b_simd_bcast(ws2812b_simd_5mhz_q2);
+    __m256i const nibble = _mm256_set1_epi8(0x0F);
+
+    size_t const blocks = size & ~(size_t)31u;
+    uint8_t * p_out = p_stream;
+
+    for(size_t i = 0; i < blocks; i += 32u)
+    {
+        __m256i const x = _mm256_loadu_si256((__m256i const *)&p_buffer[i]);
+        __m256i const lo = _mm256_and_si256(x, nibble);
+        __m256i const hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+
+        __m256i const c0 = _mm256_shuffle_epi8(t_q0, hi);
+        __m256i const c1 = _mm256_shuffle_epi8(t_q1, hi);
+        __m256i const c2 = _mm256_shuffle_epi8(t_q2, hi);
+        __m256i const c3 = _mm256_shuffle_epi8(t_q0, lo);
+        __m256i const c4 = _mm256_shuffle_epi8(t_q1, lo);
+        __m256i const c5 = _mm256_shuffle_epi8(t_q2, lo);
+
+        // Lane 0 of "l" holds storage bytes 0-7, of "h" 8-15,
+        // lane 1 of each holds 16-23 and 24-31
+        __m256i l[3];
+        __m256i h[3];
+        ws2812b_simd_ilv3_avx(ws2812b_simd_ilv3_epi16,
+                              _mm256_unpacklo_epi8(c0, c1),
+                              _mm256_unpacklo_epi8(c2, c3),
+                              _mm256_unpacklo_epi8(c4, c5),
+                              l);
+        ws2812b_simd_ilv3_avx(ws2812b_simd_ilv3_epi16,
+                              _mm256_unpackhi_epi8(c0, c1),
+                              _mm256_unpackhi_epi8(c2, c3),
+                              _mm256_unpackhi_epi8(c4, c5),
+                              h);
+
+        _mm256_storeu_si256((__m256i *)&p_out[0],   _mm256_permute2x128_si256(l[0], l[1], 0x20));
+        _mm256_storeu_si256((__m256i *)&p_out[32],  _mm256_permute2x128_si256(l[2], h[0], 0x20));
+        _mm256_storeu_si256((__m256i *)&p_out[64],  _mm256_permute2x128_si256(h[1], h[2], 0x20));
+        _mm256_storeu_si256((__m256i *)&p_out[96],  _mm256_permute2x128_si256(l[0], l[1], 0x31));
+        _mm256_storeu_si256((__m256i *)&p_out[128], _mm256_permute2x128_si256(l[2], h[0], 0x31));
+        _mm256_storeu_si256((__m256i *)&p_out[160], _mm256_permute2x128_si256(h[1], h[2], 0x31));
+        p_out += 192u;
+    }
+
+    return blocks;
+}
+
+/// Dither kernel, 16 channels per iteration (SSSE3 build, SSE2 instructions)
+///
+/// The saturating add keeps a full channel at 0xFF with an error of 0xFF,
+/// the same as the C loop.
+WS2812B_SIMD_TARGET_SSSE3
+static size_t ws2812b_simd_dither_sse(uint8_t * const p_dst,
+                                      uint8_t * const p_error,
+                                      uint16_t const * const p_src,
+                                      size_t const size)
+{
+    size_t const blocks = size & ~(size_t)15u;
+    __m128i const low = _mm_set1_epi16(0x00FF);
+    __m128i const zero = _mm_setzero_si128();
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        __m128i const err = _mm_loadu_si128((__m128i const *)&p_error[i]);
+        __m128i const s0 = _mm_adds_epu16(_mm_loadu_si128((__m128i const *)&p_src[i]),
+                                          _mm_unpacklo_epi8(err, zero));
+        __m128i const s1 = _mm_adds_epu16(_mm_loadu_si128((__m128i const *)&p_src[i + 8u]),
+                                          _mm_unpackhi_epi8(err, zero));
+
+        _mm_storeu_si128((__m128i *)&p_dst[i],
+                         _mm_packus_epi16(_mm_srli_epi16(s0, 8), _mm_srli_epi16(s1, 8)));
+        _mm_storeu_si128((__m128i *)&p_error[i],
+                         _mm_packus_epi16(_mm_and_si128(s0, low), _mm_and_si128(s1, low)));
+    }
+
+    return blocks;
+}
+
+/// Swizzle kernel, 5 pixels of 3 bytes or 4 of 4 bytes per iteration (SSSE3)
+///
+/// A byte shuffle picks the channels of one 16 byte load into GRB order,
+/// reversing the pixels when asked.  The spare store lanes land on LEDs
+/// written later, so every block needs 6 pixels left.
+WS2812B_SIMD_TARGET_SSSE3
+static size_t ws2812b_simd_swizzle_ssse3(uint8_t * const p_dst,
+                                         uint8_t const * const p_src,
+                                         size_t const count,
+                                         uint8_t const * const p_order,
+                                         size_t const pixel_sz,
+                                         bool const b_reverse)
+{
+    size_t const per_block = (4u == pixel_sz) ? 4u : 5u;
+    size_t const spare = 16u - (per_block * 3u);
+    uint8_t mask[16];
+    size_t done = 0u;
+
+    // Spare lanes are zeroed, reversed they go in front of the pixels
+    memset(mask, 0x80, sizeof(mask));
+
+    for(size_t pixel = 0; pixel < per_block; pixel++)
+    {
+        size_t const out = b_reverse ? (spare + ((per_block - 1u - pixel) * 3u)) : (pixel * 3u);
+
+        for(size_t ch = 0; ch < 3u; ch++)
+        {
+            mask[out + ch] = (uint8_t)((pixel * pixel_sz) + p_order[ch]);
+        }
+    }
+
+    __m128i const shuffle = _mm_loadu_si128((__m128i const *)mask);
+
+    for(; (done + 6u) <= count; done += per_block)
+    {
+        __m128i const x = _mm_loadu_si128((__m128i const *)&p_src[done * pixel_sz]);
+        uint8_t * const p_out = b_reverse ?
+            &p_dst[((count - done - per_block) * 3u) - spare] : &p_dst[done * 3u];
+
+        _mm_storeu_si128((__m128i *)p_out, _mm_shuffle_epi8(x, shuffle));
+    }
+
+    return done;
+}
+
+/// Byte transpose round, row k and k + 8 interleaved into rows 2k and 2k + 1
+///
+/// Four rounds turn 16 rows of 16 bytes into columns.
+WS2812B_SIMD_TARGET_SSSE3
+static inline void ws2812b_simd_zip_sse(__m128i * const p_dst, __m128i const * const p_src)
+{
+    for(size_t row = 0; row < 8u; row++)
+    {
+        p_dst[row * 2u] = _mm_unpacklo_epi8(p_src[row], p_src[row + 8u]);
+        p_dst[(row * 2u) + 1u] = _mm_unpackhi_epi8(p_src[row], p_src[row + 8u]);
+    }
+}
+
+/// Transpose kernel, 16 bytes of 16 rows per iteration (SSSE3 build, SSE2
+/// instructions)
+///
+/// The byte sign mask of a column is bit 7 of every row, doubling each byte
+/// moves the next bit up.  Words of 1 byte take two columns per mask.
+WS2812B_SIMD_TARGET_SSSE3
+static size_t ws2812b_simd_transpose_sse(uint8_t * const p_dst,
+                                         size_t const word_sz,
+                                         uint8_t const * const p_rows,
+                                         size_t const row_stride,
+                                         size_t const size)
+{
+    size_t const blocks = size & ~(size_t)15u;
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        __m128i x[16];
+        __m128i y[16];
+
+        for(size_t row = 0; row < 16u; row++)
+        {
+            x[row] = _mm_loadu_si128((__m128i const *)&p_rows[(row * row_stride) + i]);
+        }
+
+        ws2812b_simd_zip_sse(y, x);
+        ws2812b_simd_zip_sse(x, y);
+        ws2812b_simd_zip_sse(y, x);
+        ws2812b_simd_zip_sse(x, y);
+
+        if(1u == word_sz)
+        {
+            uint8_t * const p_out = &p_dst[i * 8u];
+
+            for(size_t col = 0; col < 16u; col += 2u)
+            {
+                __m128i bits = _mm_unpacklo_epi64(x[col], x[col + 1u]);
+
+                for(size_t bit = 0; bit < 8u; bit++)
+                {
+                    unsigned const mask = (unsigned)_mm_movemask_epi8(bits);
+
+                    p_out[(col * 8u) + bit] = (uint8_t)mask;
+                    p_out[(col * 8u) + 8u + bit] = (uint8_t)(mask >> 8);
+                    bits = _mm_add_epi8(bits, bits);
+                }
+            }
+        }
+        else
+        {
+            uint16_t words[128];
+
+            for(size_t col = 0; col < 16u; col++)
+            {
+                __m128i bits = x[col];
+
+                for(size_t bit = 0; bit < 8u; bit++)
+                {
+                    words[(col * 8u) + bit] = (uint16_t)_mm_movemask_epi8(bits);
+                    bits = _mm_add_epi8(bits, bits);
+                }
+            }
+
+            memcpy(&p_dst[i * 16u], words, sizeof(words));
+        }
+    }
+
+    return blocks;
+}
+
+/// Transpose kernel, 16 bytes of 16 rows per iteration (AVX2)
+///
+/// The rows are turned into columns with SSE unpacks, then two columns (four
+/// for words of 1 byte) share each 32 bit byte sign mask.
+WS2812B_SIMD_TARGET_AVX2
+static size_t ws2812b_simd_transpose_avx2(uint8_t * const p_dst,
+                                          size_t const word_sz,
+                                          uint8_t const * const p_rows,
+                                          size_t const row_stride,
+                                          size_t const size)
+{
+    size_t const blocks = size & ~(size_t)15u;
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        __m128i x[16];
+        __m128i y[16];
+
+        for(size_t row = 0; row < 16u; row++)
+        {
+            x[row] = _mm_loadu_si128((__m128i const *)&p_rows[(row * row_stride) + i]);
+        }
+
+        ws2812b_simd_zip_sse(y, x);
+        ws2812b_simd_zip_sse(x, y);
+        ws2812b_simd_zip_sse(y, x);
+        ws2812b_simd_zip_sse(x, y);
+
+        if(1u == word_sz)
+        {
+            uint8_t * const p_out = &p_dst[i * 8u];
+
+            for(size_t col = 0; col < 16u; col += 4u)
+            {
+                __m256i bits = _mm256_set_m128i(_mm_unpacklo_epi64(x[col + 2u], x[col + 3u]),
+                                                _mm_unpacklo_epi64(x[col], x[col + 1u]));
+
+                for(size_t bit = 0; bit < 8u; bit++)
+                {
+                    uint32_t const mask = (uint32_t)_mm256_movemask_epi8(bits);
+
+                    p_out[(col * 8u) + bit] = (uint8_t)mask;
+                    p_out[(col * 8u) + 8u + bit] = (uint8_t)(mask >> 8);
+                    p_out[(col * 8u) + 16u + bit] = (uint8_t)(mask >> 16);
+                    p_out[(col * 8u) + 24u + bit] = (uint8_t)(mask >> 24);
+                    bits = _mm256_add_epi8(bits, bits);
+                }
+            }
+        }
+        else
+        {
+            uint16_t words[128];
+
+            for(size_t col = 0; col < 16u; col += 2u)
+            {
+                __m256i bits = _mm256_set_m128i(x[col + 1u], x[col]);
+
+                for(size_t bit = 0; bit < 8u; bit++)
+                {
+                    uint32_t const mask = (uint32_t)_mm256_movemask_epi8(bits);
+
+                    words[(col * 8u) + bit] = (uint16_t)mask;
+                    words[(col * 8u) + 8u + bit] = (uint16_t)(mask >> 16);
+                    bits = _mm256_add_epi8(bits, bits);
+                }
+            }
+
+            memcpy(&p_dst[i * 16u], words, sizeof(words));
+        }
+    }
+
+    return blocks;
+}
+
+#elif defined(WS2812B_SIMD_NEON)
+
+/// 2.5Mhz kernel, 16 storage bytes per iteration (NEON)
+///
+/// The structured store does the 3 way interleave.
+static size_t ws2812b_simd_2p5mhz_neon(uint8_t * const p_stream,
+                                       uint8_t const * const p_buffer,
+                                       size_t const size)
+{
+    uint8x16_t const t_b0 = vld1q_u8(ws2812b_simd_2p5mhz_b0);
+    uint8x16_t const t_b1h = vld1q_u8(ws2812b_simd_2p5mhz_b1_hi);
+    uint8x16_t const t_b1l = vld1q_u8(ws2812b_simd_2p5mhz_b1_lo);
+    uint8x16_t const t_b2 = vld1q_u8(ws2812b_simd_2p5mhz_b2);
+    uint8x16_t const nibble = vdupq_n_u8(0x0F);
+
+    size_t const blocks = size & ~(size_t)15u;
+    uint8_t * p_out = p_stream;
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        uint8x16_t const x = vld1q_u8(&p_buffer[i]);
+        uint8x16_t const lo = vandq_u8(x, nibble);
+        uint8x16_t const hi = vshrq_n_u8(x, 4);
+
+        uint8x16x3_t out;
+        out.val[0] = vqtbl1q_u8(t_b0, hi);
+        out.val[1] = vorrq_u8(vqtbl1q_u8(t_b1h, hi), vqtbl1q_u8(t_b1l, lo));
+        out.val[2] = vqtbl1q_u8(t_b2, lo);
+
+        vst3q_u8(p_out, out);
+        p_out += 48u;
+    }
+
+    return blocks;
+}
+
+/// 5Mhz kernel, 16 storage bytes per iteration (NEON)
+///
+/// Stream bytes are zipped into 16 bit pairs so a 3 way structured store
+/// of halfwords writes all 6 bytes per storage byte in order.
+static size_t ws2812b_simd_5mhz_neon(uint8_t * const p_stream,
+                                     uint8_t const * const p_buffer,
+                                     size_t const size)
+{
+    uint8x16_t const t_q0 = vld1q_u8(ws2812b_simd_5mhz_q0);
+    uint8x16_t const t_q1 = vld1q_u8(ws2812b_simd_5mhz_q1);
+    uint8x16_t const t_q2 = vld1q_u8(ws2812b_simd_5mhz_q2);
+    uint8x16_t const nibble = vdupq_n_u8(0x0F);
+
+    size_t const blocks = size & ~(size_t)15u;
+    uint8_t * p_out = p_stream;
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        uint8x16_t const x = vld1q_u8(&p_buffer[i]);
+        uint8x16_t const lo = vandq_u8(x, nibble);
+        uint8x16_t const hi = vshrq_n_u8(x, 4);
+
+        uint8x16x2_t const z01 = vzipq_u8(vqtbl1q_u8(t_q0, hi), vqtbl1q_u8(t_q1, hi));
+        uint8x16x2_t const z23 = vzipq_u8(vqtbl1q_u8(t_q2, hi), vqtbl1q_u8(t_q0, lo));
+        uint8x16x2_t const z45 = vzipq_u8(vqtbl1q_u8(t_q1, lo), vqtbl1q_u8(t_q2, lo));
+
+        for(int half = 0; half < 2; half++)
+        {
+            uint16x8x3_t out;
+            out.val[0] = vreinterpretq_u16_u8(z01.val[half]);
+            out.val[1] = vreinterpretq_u16_u8(z23.val[half]);
+            out.val[2] = vreinterpretq_u16_u8(z45.val[half]);
+
+            vst3q_u16((uint16_t *)p_out, out);
+            p_out += 48u;
+        }
+    }
+
+    return blocks;
+}
+
+
+/// Dither kernel, 16 channels per iteration (NEON)
+///
+/// The saturating add keeps a full channel at 0xFF with an error of 0xFF,
+/// the same as the C loop.
+static size_t ws2812b_simd_dither_neon(uint8_t * const p_dst,
+                                       uint8_t * const p_error,
+                                       uint16_t const * const p_src,
+                                       size_t const size)
+{
+    size_t const blocks = size & ~(size_t)15u;
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        uint8x16_t const err = vld1q_u8(&p_error[i]);
+        uint16x8_t const s0 = vqaddq_u16(vld1q_u16(&p_src[i]), vmovl_u8(vget_low_u8(err)));
+        uint16x8_t const s1 = vqaddq_u16(vld1q_u16(&p_src[i + 8u]), vmovl_u8(vget_high_u8(err)));
+
+        vst1q_u8(&p_dst[i], vcombine_u8(vshrn_n_u16(s0, 8), vshrn_n_u16(s1, 8)));
+        vst1q_u8(&p_error[i], vcombine_u8(vmovn_u16(s0), vmovn_u16(s1)));
+    }
+
+    return blocks;
+}
+
+/// Swizzle kernel, 16 pixels per iteration (NEON)
+///
+/// Structured loads split the channels into registers, so reordering is
+/// picking registers and reversing is a byte reverse of each.
+static size_t ws2812b_simd_swizzle_neon(uint8_t * const p_dst,
+                                        uint8_t const * const p_src,
+                                        size_t const count,
+                                        uint8_t const * const p_order,
+                                        size_t const pixel_sz,
+                                        bool const b_reverse)
+{
+    size_t const blocks = count & ~(size_t)15u;
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        uint8x16_t ch[4];
+        uint8x16x3_t out;
+
+        if(4u == pixel_sz)
+        {
+            uint8x16x4_t const x = vld4q_u8(&p_src[i * 4u]);
+
+            ch[0] = x.val[0];
+            ch[1] = x.val[1];
+            ch[2] = x.val[2];
+            ch[3] = x.val[3];
+        }
+        else
+        {
+            uint8x16x3_t const x = vld3q_u8(&p_src[i * 3u]);
+
+            ch[0] = x.val[0];
+            ch[1] = x.val[1];
+            ch[2] = x.val[2];
+            ch[3] = x.val[2];
+        }
+
+        for(size_t c = 0; c < 3u; c++)
+        {
+            out.val[c] = ch[p_order[c]];
+
+            if(b_reverse)
+            {
+                uint8x16_t const r = vrev64q_u8(out.val[c]);
+
+                out.val[c] = vextq_u8(r, r, 8);
+            }
+        }
+
+        vst3q_u8(b_reverse ? &p_dst[(count - i - 16u) * 3u] : &p_dst[i * 3u], out);
+    }
+
+    return blocks;
+}
+
+/// Transpose kernel, 16 bytes of 16 rows per iteration (NEON)
+///
+/// Four rounds of byte zips turn the rows into columns.  There is no byte
+/// sign mask, so the set bits of a column are weighted by row and added
+/// across each half of the register.
+static size_t ws2812b_simd_transpose_neon(uint8_t * const p_dst,
+                                          size_t const word_sz,
+                                          uint8_t const * const p_rows,
+                                          size_t const row_stride,
+                                          size_t const size)
+{
+    static uint8_t const weights[16] =
+        {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t const weight = vld1q_u8(weights);
+    size_t const blocks = size & ~(size_t)15u;
+    uint8_t * p_out = p_dst;
+
+    for(size_t i = 0; i < blocks; i += 16u)
+    {
+        uint8x16_t x[16];
+        uint8x16_t y[16];
+
+        for(size_t row = 0; row < 16u; row++)
+        {
+            x[row] = vld1q_u8(&p_rows[(row * row_stride) + i]);
+        }
+
+        for(size_t round = 0; round < 4u; round++)
+        {
+            for(size_t row = 0; row < 8u; row++)
+            {
+                y[row * 2u] = vzip1q_u8(x[row], x[row + 8u]);
+                y[(row * 2u) + 1u] = vzip2q_u8(x[row], x[row + 8u]);
+            }
+
+            memcpy(x, y, sizeof(x));
+        }
+
+        for(size_t col = 0; col < 16u; col++)
+        {
+            for(size_t bit = 0; bit < 8u; bit++)
+            {
+                uint8x16_t const m =
+                    vandq_u8(vtstq_u8(x[col], vdupq_n_u8((uint8_t)(0x80u >> bit))), weight);
+                uint16_t const word = (uint16_t)(vaddv_u8(vget_low_u8(m)) |
+                                                 ((unsigned)vaddv_u8(vget_high_u8(m)) << 8));
+
+                if(1u == word_sz)
+                {
+                    *p_out = (uint8_t)word;
+                }
+                else
+                {
+                    memcpy(p_out, &word, sizeof(word));
+                }
+
+                p_out += word_sz;
+            }
+        }
+    }
+
+    return blocks;
+}
+#endif
+
+
+#if !defined(WS2812B_SIMD_NEON)
+/// Portable C only, every kernel NULL
+static ws2812b_simd_kernels_t const simd_none = {NULL, NULL, NULL, NULL, NULL};
+#endif
+
+#if defined(WS2812B_SIMD_X86)
+/// AVX2 capable CPUs
+static ws2812b_simd_kernels_t const simd_avx2 =
+{
+    ws2812b_simd_2p5mhz_avx2,
+    ws2812b_simd_5mhz_avx2,
+    ws2812b_simd_dither_sse,
+    ws2812b_simd_swizzle_ssse3,
+    ws2812b_simd_transpose_avx2
+};
+
+/// SSSE3 capable CPUs
+static ws2812b_simd_kernels_t const simd_ssse3 =
+{
+    ws2812b_simd_2p5mhz_ssse3,
+    ws2812b_simd_5mhz_ssse3,
+    ws2812b_simd_dither_sse,
+    ws2812b_simd_swizzle_ssse3,
+    ws2812b_simd_transpose_sse
+};
+
+/// Table picked by the first ws2812b_simd_kernels, NULL before that
+static ws2812b_simd_kernels_t const * p_simd_selected = NULL;
+#elif defined(WS2812B_SIMD_NEON)
+/// NEON is part of the AArch64 base ISA, nothing to probe
+static ws2812b_simd_kernels_t const simd_neon =
+{
+    ws2812b_simd_2p5mhz_neon,
+    ws2812b_simd_5mhz_neon,
+    ws2812b_simd_dither_neon,
+    ws2812b_simd_swizzle_neon,
+    ws2812b_simd_transpose_neon
+};
+#endif
+
+
+/// Get the widest kernels the running CPU supports
+///
+/// The CPU is probed on the first call.  Any thread may call it: racing
+/// first calls pick the same table and publish it with an atomic store.
+///
+/// @return The kernels to use, entries are NULL when only the portable C
+///         encoder is available
+ws2812b_simd_kernels_t const * ws2812b_simd_kernels(void)
+{
+#if defined(WS2812B_SIMD_X86)
+    ws2812b_simd_kernels_t const * p_kernels =
+        __atomic_load_n(&p_simd_selected, __ATOMIC_ACQUIRE);
+
+    if(NULL == p_kernels)
+    {
+        __builtin_cpu_init();
+
+        if(__builtin_cpu_supports("avx2"))
+        {
+            p_kernels = &simd_avx2;
+        }
+        else if(__builtin_cpu_supports("ssse3"))
+        {
+            p_kernels = &simd_ssse3;
+        }
+        else
+        {
+            p_kernels = &simd_none;
+        }
+
+        __atomic_store_n(&p_simd_selected, p_kernels, __ATOMIC_RELEASE);
+    }
+
+    return p_kernels;
+#elif defined(WS2812B_SIMD_NEON)
+    return &simd_neon;
+#else
+    return &simd_none;
+#endif
+}
@@ -0,0 +1,73 @@
+/// ws2812b_data_simd
+///
+/// Vectorized bulk encode kernels used by ws2812b_data to build the SPI stream
+
+#ifndef WS2812B_DATA_SIMD_H_
+#define WS2812B_DATA_SIMD_H_
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+
+
+/// Bulk encode kernel
+///
+/// Encodes as many whole blocks of the storage buffer as the kernel handles
+/// and returns how many storage bytes were consumed.  The caller finishes the
+/// remainder with the portable C encoder.
+typedef size_t (*ws2812b_simd_kernel_t)(uint8_t * const p_stream,
+                                        uint8_t const * const p_buffer,
+                                        size_t const size);
+
+/// Bulk dither kernel
+///
+/// Quantizes as many whole blocks of 16 bit channels to 8 bits as the kernel
+/// handles, carrying the rounding error in p_error, and returns how many
+/// channels were done.  The caller finishes the remainder in C.
+typedef size_t (*ws2812b_simd_dither_t)(uint8_t * const p_dst,
+                                        uint8_t * const p_error,
+                                        uint16_t const * const p_src,
+                                        size_t const size);
+
+/// Bulk swizzle kernel
+///
+/// Copies as many packed source pixels of pixel_sz (3 or 4) bytes into GRB
+/// storage as the kernel handles and returns how many were done.  p_order
+/// holds the source offsets of green, red and blue.  Reversed, source pixel
+/// 0 goes to the last of the count LEDs at p_dst.  The caller finishes the
+/// remainder in C.
+typedef size_t (*ws2812b_simd_swizzle_t)(uint8_t * const p_dst,
+                                         uint8_t const * const p_src,
+                                         size_t const count,
+                                         uint8_t const * const p_order,
+                                         size_t const pixel_sz,
+                                         bool const b_reverse);
+
+/// Bulk lane transpose kernel
+///
+/// Bit transposes as many whole blocks of 16 bytes of 16 lane rows as the
+/// kernel handles and returns how many bytes of each row were done.  Byte i
+/// of the rows becomes 8 words at p_dst, the first from bit 7, with bit k of
+/// a word from row k.  Words of 1 byte keep rows 0 to 7, words of 2 bytes
+/// are stored in the CPU byte order.  The caller finishes the remainder in C.
+typedef size_t (*ws2812b_simd_transpose_t)(uint8_t * const p_dst,
+                                           size_t const word_sz,
+                                           uint8_t const * const p_rows,
+                                           size_t const row_stride,
+                                           size_t const size);
+
+/// Kernels picked for the running CPU, NULL when there is no vector support
+typedef struct
+{
+    ws2812b_simd_kernel_t encode_2p5mhz; ///< Kernel for the 2.5Mhz stream format
+    ws2812b_simd_kernel_t encode_5mhz;   ///< Kernel for the 5Mhz stream format
+    ws2812b_simd_dither_t dither;        ///< Kernel for 16 bit temporal dithering
+    ws2812b_simd_swizzle_t swizzle;      ///< Kernel for ws2812b_data_blit
+    ws2812b_simd_transpose_t transpose;  ///< Kernel for ws2812b_lanes
+}
+ws2812b_simd_kernels_t;
+
+
+ws2812b_simd_kernels_t const * ws2812b_simd_kernels(void);
+
+#endif /* WS2812B_DATA_SIMD_H_ */
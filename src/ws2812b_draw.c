@@ -9,75 +9,481 @@
 #include <stdint.h>
 
 
-// Store pointers locally to just make life easier
-// This is an effort to make this module work with multiple
-// LED strips while keeping the parameter overhead low for all the function calls.
-// I don't know if I care for it, BUT I've already committed and it works.
-static ws2812b_t * p_strip;
-static ws2812b_draw_object_t * p_objs;
-static size_t objects_count = 0;
-
-static int32_t tick_ms_elapsed = 0;
-static int32_t tick_ms_value = 0;
+// Context used by the ws2812b_draw_... functions that don't take one.
+// This keeps the parameter overhead low for apps with a single strip,
+// apps with more strips give each one its own ws2812b_draw_ctx_t.
+static ws2812b_draw_ctx_t default_ctx =
+{
+    .p_strip = NULL,
+    .p_objs = NULL,
+    .objects_count = 0,
+    .tick_ms_elapsed = 0,
+    .tick_ms_value = 0,
+    .mode = DRAW_MODE_BUFFER,
+    .effect_red = WS2812_POWER_VAL,
+    .effect_green = 0x0,
+    .effect_blue = 0x0,
+    .p_soa = NULL,
+    .p_events = NULL,
+    .events_key = 0,
+    .b_redraw = false,
+    .p_paint = NULL,
+    .damage = {0u, 0u},
+    .b_damage_all = false,
+};
+
+/// No blink or position update pending, see ws2812b_draw_event_t
+#define WS2812B_DRAW_NO_EVENT_MS INT32_MAX
+
+/// Pack a color as stored in ws2812b_draw_soa_t::p_color
+#define WS2812B_DRAW_COLOR(red, green, blue) \
+    (((uint32_t)(red) << 16) | ((uint32_t)(green) << 8) | (uint32_t)(blue))
 
 
 static bool ws2812b_position_in_range(size_t const led_count, size_t const position);
-static void ws2812b_update_position(size_t const element);
-static void ws2812b_draw_object(size_t element);
+static void ws2812b_update_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element);
+static bool ws2812b_can_move(ws2812b_draw_ctx_t const * const p_ctx,
+                             ws2812b_draw_object_t const * const p_obj);
+static void ws2812b_step_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element);
+static void ws2812b_step_position_x(ws2812b_draw_ctx_t * const p_ctx,
+                                    size_t const element,
+                                    int64_t steps);
+static void ws2812b_update_blink(ws2812b_draw_ctx_t * const p_ctx, size_t const element);
+static void ws2812b_toggle_blink(ws2812b_draw_ctx_t * const p_ctx, size_t const element);
+static void ws2812b_soa_update_blinks(ws2812b_draw_ctx_t * const p_ctx);
+static void ws2812b_soa_update_positions(ws2812b_draw_ctx_t * const p_ctx);
+static void ws2812b_soa_sync(ws2812b_draw_ctx_t * const p_ctx, size_t const element);
+static void ws2812b_draw_changed(ws2812b_draw_ctx_t * const p_ctx, size_t const element);
+static void ws2812b_events_schedule(ws2812b_draw_ctx_t * const p_ctx, size_t const element);
+static int64_t ws2812b_events_key(ws2812b_draw_ctx_t const * const p_ctx,
+                                  size_t const element,
+                                  int64_t const after_key);
+static void ws2812b_events_run(ws2812b_draw_ctx_t * const p_ctx, int64_t const limit_key);
+static void ws2812b_events_run_object(ws2812b_draw_ctx_t * const p_ctx,
+                                      size_t const element,
+                                      int64_t const limit_key);
+static void ws2812b_events_sift_up(ws2812b_draw_event_t * const p_events, size_t heap_idx);
+static void ws2812b_events_sift_down(ws2812b_draw_event_t * const p_events,
+                                     size_t const count,
+                                     size_t heap_idx);
+static void ws2812b_draw_object(ws2812b_draw_ctx_t const * const p_ctx,
+                                ws2812b_t * const p_instance,
+                                size_t const element);
+static bool ws2812b_draw_get_paint(ws2812b_draw_ctx_t const * const p_ctx,
+                                   ws2812b_t const * const p_instance,
+                                   size_t const element,
+                                   ws2812b_draw_paint_t * const p_paint);
+static void ws2812b_draw_damage(ws2812b_draw_ctx_t * const p_ctx);
+static void ws2812b_draw_repaint(ws2812b_draw_ctx_t * const p_ctx);
+static void ws2812b_draw_fill(ws2812b_draw_ctx_t const * const p_ctx,
+                              ws2812b_t * const p_instance,
+                              size_t const position,
+                              size_t const length,
+                              uint8_t const red,
+                              uint8_t const green,
+                              uint8_t const blue);
+static ws2812b_draw_object_t * ws2812b_draw_get_obj(ws2812b_draw_ctx_t const * const p_ctx,
+                                                    size_t const element);
+
+/// Reset a draw context
+///
+/// Call once before the first ws2812b_draw_ctx_setup of a context.
+///
+/// @param p_ctx The context to reset
+void ws2812b_draw_ctx_init(ws2812b_draw_ctx_t * const p_ctx)
+{
+    if(NULL != p_ctx)
+    {
+        p_ctx->p_strip = NULL;
+        p_ctx->p_objs = NULL;
+        p_ctx->objects_count = 0;
+        p_ctx->tick_ms_elapsed = 0;
+        p_ctx->tick_ms_value = 0;
+        p_ctx->mode = DRAW_MODE_BUFFER;
+        p_ctx->effect_red = WS2812_POWER_VAL;
+        p_ctx->effect_green = 0x0;
+        p_ctx->effect_blue = 0x0;
+        p_ctx->p_soa = NULL;
+        p_ctx->p_events = NULL;
+        p_ctx->events_key = 0;
+        p_ctx->b_redraw = false;
+        p_ctx->p_paint = NULL;
+        p_ctx->damage.start = 0u;
+        p_ctx->damage.end = 0u;
+        p_ctx->b_damage_all = false;
+    }
+}
 
 /// Draw the objects, update the tick counter
 ///
+/// With an event schedule (ws2812b_draw_ctx_set_events) only objects with
+/// a blink, move or expiry due are touched, and the strip is only drawn
+/// again when something changed.  That draw still covers every object, see
+/// ws2812b_draw_event_t for the cost.
+///
+/// @param p_ctx   The draw context
 /// @param tick_ms The amount of ticks in milli-seconds that have elapsed
-void ws2812b_draw(int32_t tick_ms)
+void ws2812b_draw_ctx_draw(ws2812b_draw_ctx_t * const p_ctx, int32_t tick_ms)
+{
+    if(NULL != p_ctx)
+    {
+        p_ctx->tick_ms_elapsed += tick_ms;
+        p_ctx->tick_ms_value = tick_ms;
+
+        if( (NULL != p_ctx->p_objs) &&
+            (NULL != p_ctx->p_strip) &&
+            (0 < p_ctx->objects_count) &&
+            (NULL != p_ctx->p_events) )
+          {
+              int64_t const tick_key = 2 * (int64_t)p_ctx->tick_ms_elapsed;
+
+              // Blinks and expiry, then draw, then moves, same as below
+              ws2812b_events_run(p_ctx, tick_key);
+
+              if(p_ctx->b_redraw)
+              {
+                  ws2812b_draw_repaint(p_ctx);
+                  p_ctx->b_redraw = false;
+              }
+
+              ws2812b_events_run(p_ctx, tick_key + 1);
+          }
+        else if( (NULL != p_ctx->p_objs) &&
+                 (NULL != p_ctx->p_strip) &&
+                 (0 < p_ctx->objects_count) )
+          {
+              // Each object only depends on itself, so blinking all,
+              // drawing all, then moving all draws the same frame as
+              // handling the objects one at a time
+              if(NULL != p_ctx->p_soa)
+              {
+                  ws2812b_soa_update_blinks(p_ctx);
+                  ws2812b_draw_repaint(p_ctx);
+                  ws2812b_soa_update_positions(p_ctx);
+              }
+              else
+              {
+                  for(size_t idx = 0; idx < p_ctx->objects_count; idx++)
+                  {
+                      ws2812b_update_blink(p_ctx, idx);
+                  }
+
+                  ws2812b_draw_repaint(p_ctx);
+
+                  for(size_t idx = 0; idx < p_ctx->objects_count; idx++)
+                  {
+                      ws2812b_update_position(p_ctx, idx);
+                  }
+              }
+          }
+    }
+}
+
+/// Draw the objects at an absolute time, for apps that sleep between changes
+///
+/// Needs an event schedule (ws2812b_draw_ctx_set_events).  Every blink,
+/// move and expiry up to now_ms is caught up on, however long since the
+/// last call: blinks toggle by the number that were missed and moves
+/// skip whole cycles, so a long gap costs about the same as a short one.
+/// The strip is drawn only if something changed.  Moves due at now_ms are
+/// drawn right away instead of on the next tick, so the strip is always
+/// up to date when this returns.
+///
+/// Without an event schedule this is a ws2812b_draw_ctx_draw of the time
+/// since the last call and 1 is returned.
+///
+/// @param p_ctx  The draw context
+/// @param now_ms Time in milli-seconds since the objects were set up,
+///               it must not go backwards
+///
+/// @return Milli-seconds until the next change, the app can sleep until
+///         then, WS2812B_DRAW_FOREVER if nothing is going to change
+int32_t ws2812b_draw_ctx_draw_at(ws2812b_draw_ctx_t * const p_ctx, int32_t const now_ms)
 {
+    int32_t sleep_ms = 1;
+
+    if(NULL != p_ctx)
+    {
+        int32_t const tick_ms = (now_ms > p_ctx->tick_ms_elapsed) ?
+            (now_ms - p_ctx->tick_ms_elapsed) : 0;
+
+        if( (NULL != p_ctx->p_objs) &&
+            (NULL != p_ctx->p_strip) &&
+            (0 < p_ctx->objects_count) &&
+            (NULL != p_ctx->p_events) )
+          {
+              ws2812b_draw_event_t const * const p_events = p_ctx->p_events;
+              int64_t next_key;
+
+              p_ctx->tick_ms_elapsed += tick_ms;
+              p_ctx->tick_ms_value = tick_ms;
 
-    tick_ms_elapsed += tick_ms;
-    tick_ms_value = tick_ms;
+              ws2812b_events_run(p_ctx, (2 * (int64_t)p_ctx->tick_ms_elapsed) + 1);
 
-    if( (NULL != p_objs) &&
-        (NULL != p_strip) &&
-        (0 < objects_count) )
+              if(p_ctx->b_redraw)
+              {
+                  ws2812b_draw_repaint(p_ctx);
+                  p_ctx->b_redraw = false;
+              }
+
+              next_key = p_events[p_events[0].heap].key;
+
+              sleep_ms = (WS2812B_DRAW_NO_EVENT == next_key) ?
+                  WS2812B_DRAW_FOREVER :
+                  (int32_t)((next_key / 2) - p_ctx->tick_ms_elapsed);
+          }
+        else
+          {
+              ws2812b_draw_ctx_draw(p_ctx, tick_ms);
+          }
+    }
+
+    return sleep_ms;
+}
+
+/// Draw the objects as they are now onto a strip
+///
+/// No object is changed, so the same context can be rendered to several
+/// strips, from several threads, as long as nothing else is updating it.
+/// Objects that moved during the last ws2812b_draw_ctx_draw are drawn at
+/// their new position.
+///
+/// The whole strip is cleared first, so every render costs O(led_count) in
+/// the context mode even when the objects cover a few LEDs.  The const
+/// context keeps no per strip record of the last frame, so to only clear
+/// and draw what changed use ws2812b_draw_ctx_set_damage, which does so for
+/// the context's own strip.
+///
+/// @param p_ctx       The draw context
+/// @param p_instance  The strip to draw on, uses the context mode
+void ws2812b_draw_ctx_render(ws2812b_draw_ctx_t const * const p_ctx,
+                             ws2812b_t * const p_instance)
+{
+    if( (NULL != p_ctx) &&
+        (NULL != p_ctx->p_objs) &&
+        (NULL != p_instance) &&
+        !((DRAW_MODE_STREAM == p_ctx->mode) && p_instance->b_in_place) &&
+        (0 < p_ctx->objects_count) )
       {
           // Clear out last draw
-          ws2812b_data_clear_all(p_strip);
+          ws2812b_draw_fill(p_ctx, p_instance, 1u, p_instance->led_count, WS2812B_BLACK);
 
           // Draw all the elements
-          for(size_t idx = 0; idx < objects_count; idx++)
+          for(size_t idx = 0; idx < p_ctx->objects_count; idx++)
           {
-              ws2812b_draw_object((size_t)idx);
-              ws2812b_update_position((size_t)idx);
+              ws2812b_draw_object(p_ctx, p_instance, idx);
           }
       }
 }
 
-/// Update internal pointers to use the instances specified here
+/// Update context pointers to use the instances specified here
 ///
+/// @param p_ctx            The draw context
 /// @param p_objects_store  The draw objects to initialize
 /// @param p_instance       The instance to the ws2812b_t data
-void ws2812b_draw_setup(ws2812b_draw_objects_store_t * const p_objects_store,
-                        ws2812b_t * const p_instance)
+void ws2812b_draw_ctx_setup(ws2812b_draw_ctx_t * const p_ctx,
+                            ws2812b_draw_objects_store_t * const p_objects_store,
+                            ws2812b_t * const p_instance)
 {
-    if( (NULL != p_objects_store) &&
+    if( (NULL != p_ctx) &&
+        (NULL != p_objects_store) &&
         (NULL != p_instance) &&
         (0 < p_objects_store->object_count) )
 
       {
-          p_strip = p_instance;
-          p_objs = p_objects_store->p_objects;
-          objects_count = p_objects_store->object_count;
+          p_ctx->p_strip = p_instance;
+          p_ctx->p_objs = p_objects_store->p_objects;
+          p_ctx->objects_count = p_objects_store->object_count;
+          p_ctx->p_soa = p_objects_store->p_soa;
+          p_ctx->p_events = NULL;
+          p_ctx->p_paint = NULL;
+
+          if(NULL != p_ctx->p_soa)
+          {
+              for(size_t idx = 0; idx < p_ctx->objects_count; idx++)
+              {
+                  ws2812b_soa_sync(p_ctx, idx);
+              }
+          }
       }
 }
 
+/// Give a context an event schedule
+///
+/// Call after ws2812b_draw_ctx_setup.  Every object gets its next blink,
+/// move and expiry time, and a tick only handles the objects that have an
+/// event due, so the cost grows with the events, not the objects.  The
+/// strip is only drawn again when an event or a ws2812b_draw_ctx_set_...
+/// call changed something, so the app must not draw on the strip itself.
+/// Objects changed without a set function need ws2812b_draw_ctx_set_events
+/// to be called again.
+///
+/// An event due between two ticks is handled on the next tick instead of
+/// being skipped.  With ticks that divide the rates the strip is drawn the
+/// same as without a schedule.
+///
+/// @param p_ctx        The draw context
+/// @param p_events     One event per object, NULL to check every object every tick
+/// @param events_count The number of events in p_events
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_draw_ctx_set_events(ws2812b_draw_ctx_t * const p_ctx,
+                                 ws2812b_draw_event_t * const p_events,
+                                 size_t const events_count)
+{
+    bool b_result = false;
+
+    if(NULL != p_ctx)
+    {
+        p_ctx->p_events = NULL;
+
+        if(NULL == p_events)
+        {
+            b_result = true;
+        }
+        else if( (NULL != p_ctx->p_objs) &&
+                 (NULL != p_ctx->p_strip) &&
+                 (0 < p_ctx->objects_count) &&
+                 (p_ctx->objects_count <= events_count) )
+        {
+            size_t const count = p_ctx->objects_count;
+
+            p_ctx->p_events = p_events;
+            p_ctx->events_key = (2 * (int64_t)p_ctx->tick_ms_elapsed) + 1;
+            p_ctx->b_redraw = true;
+
+            for(size_t idx = 0; idx < count; idx++)
+            {
+                p_events[idx].heap = idx;
+                p_events[idx].heap_idx = idx;
+                ws2812b_events_schedule(p_ctx, idx);
+            }
+
+            for(size_t idx = count / 2u; idx > 0u; idx--)
+            {
+                ws2812b_events_sift_down(p_events, count, idx - 1u);
+            }
+
+            b_result = true;
+        }
+    }
+
+    return b_result;
+}
+
+/// Select where objects are drawn
+///
+/// DRAW_MODE_BUFFER (default) draws into the storage buffer and the app
+/// runs a ws2812b_update_stream... function afterwards.
+///
+/// DRAW_MODE_STREAM encodes each object color once per frame and copies
+/// the pattern straight into ws2812b_t::p_stream.  The storage buffer is
+/// not used, so the app sends the stream right after ws2812b_draw and
+/// must not call the ws2812b_update_stream... functions.  An in place strip
+/// (ws2812b_data_init_in_place) keeps its storage in the stream, nothing is
+/// drawn on it in this mode.
+///
+/// @param p_ctx The draw context
+/// @param mode  The draw mode to use
+void ws2812b_draw_ctx_set_mode(ws2812b_draw_ctx_t * const p_ctx, ws2812b_draw_mode_t const mode)
+{
+    if(NULL != p_ctx)
+    {
+        p_ctx->mode = mode;
+
+        // The other buffer has none of the last draw
+        p_ctx->b_damage_all = true;
+        p_ctx->b_redraw = true;
+    }
+}
+
+/// Only draw the LEDs that change
+///
+/// Call after ws2812b_draw_ctx_setup.  The context keeps what each object
+/// painted on the last draw (position, length, color, drawn or not) in
+/// p_paint.  A draw then only clears and draws again the LEDs under
+/// objects that changed, in object order, instead of the whole strip.  A
+/// static scene draws nothing and leaves nothing to encode.  The app must
+/// not draw on the strip itself.
+///
+/// @param p_ctx       The draw context
+/// @param p_paint     One paint per object, NULL to draw the whole strip every time
+/// @param paint_count The number of paints in p_paint
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_draw_ctx_set_damage(ws2812b_draw_ctx_t * const p_ctx,
+                                 ws2812b_draw_paint_t * const p_paint,
+                                 size_t const paint_count)
+{
+    bool b_result = false;
+
+    if(NULL != p_ctx)
+    {
+        p_ctx->p_paint = NULL;
+
+        if(NULL == p_paint)
+        {
+            b_result = true;
+        }
+        else if( (NULL != p_ctx->p_objs) &&
+                 (NULL != p_ctx->p_strip) &&
+                 (0 < p_ctx->objects_count) &&
+                 (p_ctx->objects_count <= paint_count) )
+        {
+            for(size_t idx = 0; idx < p_ctx->objects_count; idx++)
+            {
+                p_paint[idx].position = 0u;
+                p_paint[idx].length = 0u;
+                p_paint[idx].color = 0u;
+                p_paint[idx].b_painted = false;
+            }
+
+            p_ctx->p_paint = p_paint;
+            p_ctx->b_damage_all = true;
+            p_ctx->b_redraw = true;
+
+            b_result = true;
+        }
+    }
+
+    return b_result;
+}
+
+/// Get the LEDs the last draw changed
+///
+/// @param p_ctx  The draw context
+/// @param p_span Where to store the changed LEDs, 0 based, end not included
+///
+/// @return TRUE if the last draw changed any LED, FALSE otherwise
+bool ws2812b_draw_ctx_get_damage(ws2812b_draw_ctx_t const * const p_ctx,
+                                 ws2812b_span_t * const p_span)
+{
+    bool b_result = false;
+
+    if((NULL != p_ctx) && (NULL != p_span))
+    {
+        *p_span = p_ctx->damage;
+        b_result = (p_span->start < p_span->end);
+    }
+
+    return b_result;
+}
+
 /// Initialize all objects to not draw
-void ws2812b_draw_clear_objects()
+///
+/// @param p_ctx The draw context
+void ws2812b_draw_ctx_clear_objects(ws2812b_draw_ctx_t * const p_ctx)
 {
-    if( (NULL != p_objs) &&
-        (NULL != p_strip) &&
-        (0 < objects_count) )
+    if( (NULL != p_ctx) &&
+        (NULL != p_ctx->p_objs) &&
+        (NULL != p_ctx->p_strip) &&
+        (0 < p_ctx->objects_count) )
 
       {
+          ws2812b_draw_object_t * const p_objs = p_ctx->p_objs;
+
           // Disable everything
-          for(size_t idx = 0; idx < objects_count; idx++)
+          for(size_t idx = 0; idx < p_ctx->objects_count; idx++)
           {
               p_objs[idx].action = DRAW_ACTION_NO_DRAW;
               p_objs[idx].direction = DIRECTION_NOT_MOVING;
@@ -95,6 +501,8 @@ void ws2812b_draw_clear_objects()
               p_objs[idx].b_grow = false;
               p_objs[idx].b_reverse = false;
               p_objs[idx].b_hit_end = false;
+
+              ws2812b_draw_changed(p_ctx, idx);
           }
       }
 }
@@ -104,16 +512,19 @@ void ws2812b_draw_clear_objects()
 /// The action property defines if an object is to be drawn
 /// a solid, blinking, or not drawn
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param action  The property value to set
-void ws2812b_draw_set_action(size_t const element, ws2812b_draw_action_t action)
+void ws2812b_draw_ctx_set_action(ws2812b_draw_ctx_t * const p_ctx, size_t const element, ws2812b_draw_action_t action)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
 
-      {
-          p_objs[element].action = action;
-      }
+    if(NULL != p_obj)
+    {
+        p_obj->action = action;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property direction
@@ -121,15 +532,19 @@ void ws2812b_draw_set_action(size_t const element, ws2812b_draw_action_t action)
 /// The direction property defines if an object is not moving, or
 /// moving forward or backwards
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param direction  The property value to set
-void ws2812b_draw_set_direction(size_t const element, ws2812b_direction_t direction)
+void ws2812b_draw_ctx_set_direction(ws2812b_draw_ctx_t * const p_ctx, size_t const element, ws2812b_direction_t direction)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].direction = direction;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->direction = direction;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property blink state
@@ -139,15 +554,19 @@ void ws2812b_draw_set_direction(size_t const element, ws2812b_direction_t direct
 /// By default it starts with OFF. The DRAW_ACTION_BLINK... actions
 /// will update this automatically.
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param state  The property value to set
-void ws2812b_draw_set_blink_state(size_t const element, ws2812b_blink_state_t const state)
+void ws2812b_draw_ctx_set_blink_state(ws2812b_draw_ctx_t * const p_ctx, size_t const element, ws2812b_blink_state_t const state)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].blink_state = state;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->blink_state = state;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property blink rate
@@ -155,15 +574,19 @@ void ws2812b_draw_set_blink_state(size_t const element, ws2812b_blink_state_t co
 /// The blink rate property defines how often a blink occurs
 /// for an object
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param rate_ms  The property value to set
-void ws2812b_draw_set_blink_rate(size_t const element, int32_t const rate_ms)
+void ws2812b_draw_ctx_set_blink_rate(ws2812b_draw_ctx_t * const p_ctx, size_t const element, int32_t const rate_ms)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].blink_rate_ms = rate_ms;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->blink_rate_ms = rate_ms;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property duration
@@ -171,37 +594,45 @@ void ws2812b_draw_set_blink_rate(size_t const element, int32_t const rate_ms)
 /// The duration property defines how long an object will be
 /// drawn
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param duration  The property value to set
-void ws2812b_draw_set_duration(size_t const element, int32_t const duration_ms)
+void ws2812b_draw_ctx_set_duration(ws2812b_draw_ctx_t * const p_ctx, size_t const element, int32_t const duration_ms)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          if(0 <= duration_ms )
-          {
-              p_objs[element].duration_ms = tick_ms_elapsed + duration_ms;
-          }
-          else
-          {
-              p_objs[element].duration_ms = 0x7FFFFFFF;
-          }
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        if(0 <= duration_ms )
+        {
+            p_obj->duration_ms = p_ctx->tick_ms_elapsed + duration_ms;
+        }
+        else
+        {
+            p_obj->duration_ms = 0x7FFFFFFF;
+        }
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property length
 ///
 /// The length property defines how long an object is.
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param length  The property value to set
-void ws2812b_draw_set_length(size_t const element, size_t const length)
+void ws2812b_draw_ctx_set_length(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const length)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].length = length;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->length = length;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property increment rate
@@ -210,52 +641,65 @@ void ws2812b_draw_set_length(size_t const element, size_t const length)
 /// position based on the ticks.  This is only used when traveling
 /// in a direction
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param rate_ms  The property value to set
-void ws2812b_draw_set_increment_rate(size_t const element, size_t const rate_ms)
+void ws2812b_draw_ctx_set_increment_rate(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const rate_ms)
 {
-  if( (NULL != p_objs) &&
-      (element < objects_count) )
-      {
-          p_objs[element].increment_rate_ms = rate_ms;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->increment_rate_ms = rate_ms;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property position
 ///
 /// The position property defines the current position
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param position  The property value to set
-void ws2812b_draw_set_position(size_t const element, size_t const position)
+void ws2812b_draw_ctx_set_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const position)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].position = position;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->position = position;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property color (RGB)
 ///
 /// The color property defines the RGB value that each object is
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param red    The property value to set
 /// @param green  The property value to set
 /// @param blue   The property value to set
-void ws2812b_draw_set_color(size_t const element,
-                    uint8_t const red,
-                    uint8_t const green,
-                    uint8_t const blue)
+void ws2812b_draw_ctx_set_color(ws2812b_draw_ctx_t * const p_ctx,
+                                size_t const element,
+                                uint8_t const red,
+                                uint8_t const green,
+                                uint8_t const blue)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].red = red;
-          p_objs[element].green = green;
-          p_objs[element].blue = blue;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->red = red;
+        p_obj->green = green;
+        p_obj->blue = blue;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property start position
@@ -263,15 +707,19 @@ void ws2812b_draw_set_color(size_t const element,
 /// The start position property defines the start position of an object
 /// This is only used when object is traveling in a direction.
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param position The property value to set
-void ws2812b_draw_set_start_position(size_t const element, size_t const position)
+void ws2812b_draw_ctx_set_start_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const position)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].start_position = position;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->start_position = position;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property end position
@@ -279,15 +727,19 @@ void ws2812b_draw_set_start_position(size_t const element, size_t const position
 /// The end position property defines the end position of an object
 /// This is only used when object is traveling in a direction.
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param position The property value to set
-void ws2812b_draw_set_end_position(size_t const element, size_t const position)
+void ws2812b_draw_ctx_set_end_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const position)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].end_position = position;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->end_position = position;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property grow
@@ -298,15 +750,19 @@ void ws2812b_draw_set_end_position(size_t const element, size_t const position)
 ///
 /// If not set, then the object position is updated.
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param b_grow The property value to set
-void ws2812b_draw_set_grow(size_t const element, bool const b_grow)
+void ws2812b_draw_ctx_set_grow(ws2812b_draw_ctx_t * const p_ctx, size_t const element, bool const b_grow)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].b_grow = b_grow;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->b_grow = b_grow;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Set object property reverse
@@ -316,79 +772,89 @@ void ws2812b_draw_set_grow(size_t const element, bool const b_grow)
 ///
 /// If not set the object will stay at the last position for it's direction
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param b_resverse The property value to set
-void ws2812b_draw_set_reverse(size_t const element, bool const b_reverse)
+void ws2812b_draw_ctx_set_reverse(ws2812b_draw_ctx_t * const p_ctx, size_t const element, bool const b_reverse)
 {
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          p_objs[element].b_reverse = b_reverse;
-      }
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
+
+    if(NULL != p_obj)
+    {
+        p_obj->b_reverse = b_reverse;
+
+        ws2812b_draw_changed(p_ctx, element);
+    }
 }
 
 /// Get if the position hit the start position or end position
 ///
 /// This only happens when the object is traveling in a direction
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 ///
 /// @return True if the current position equals the start or end position
-bool ws2812b_draw_get_hit(size_t const element)
+bool ws2812b_draw_ctx_get_hit(ws2812b_draw_ctx_t * const p_ctx, size_t const element)
 {
     bool b_ret_val = false;
+    ws2812b_draw_object_t * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
 
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          if(p_objs[element].b_hit_end)
-          {
-              b_ret_val = true;
-              p_objs[element].b_hit_end = false;
-          }
-      }
+    if(NULL != p_obj)
+    {
+        if(p_obj->b_hit_end)
+        {
+            b_ret_val = true;
+            p_obj->b_hit_end = false;
+        }
+    }
 
     return b_ret_val;
 }
 
 /// Get if the direction of the object
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 ///
 /// @return The direction of the object
-ws2812b_direction_t ws2812b_draw_get_direction(size_t const element)
+ws2812b_direction_t ws2812b_draw_ctx_get_direction(ws2812b_draw_ctx_t const * const p_ctx, size_t const element)
 {
     ws2812b_direction_t ret_val = DIRECTION_NOT_MOVING;
+    ws2812b_draw_object_t const * const p_obj = ws2812b_draw_get_obj(p_ctx, element);
 
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
-      {
-          ret_val = p_objs[element].direction;
-      }
+    if(NULL != p_obj)
+    {
+        ret_val = p_obj->direction;
+    }
 
     return ret_val;
 }
 
 /// Check if two objects overlap at any point
 ///
+/// @param p_ctx     The draw context
 /// @param element_1 The element for an object to check
 /// @param element_2 The element for an object to check
 ///
 /// @return True if overlap, false otherwise
-bool ws2812b_draw_get_obj_overlap(size_t const element_1,
-                                  size_t const element_2)
+bool ws2812b_draw_ctx_get_obj_overlap(ws2812b_draw_ctx_t const * const p_ctx,
+                                      size_t const element_1,
+                                      size_t const element_2)
 {
     bool b_ret_val = false;
+    ws2812b_draw_object_t const * const p_obj_1 = ws2812b_draw_get_obj(p_ctx, element_1);
+    ws2812b_draw_object_t const * const p_obj_2 = ws2812b_draw_get_obj(p_ctx, element_2);
 
-    if((NULL != p_objs) &&
-      (objects_count > element_1) &&
-      (objects_count > element_2))
+    if((NULL != p_obj_1) && (NULL != p_obj_2))
       {
-          size_t const e1_start = p_objs[element_1].position;
-          size_t const e1_end = e1_start + p_objs[element_1].length-1u;
+          ws2812b_draw_soa_t const * const p_soa = p_ctx->p_soa;
+
+          size_t const e1_start = (NULL != p_soa) ? p_soa->p_position[element_1] : p_obj_1->position;
+          size_t const e1_end = e1_start + ((NULL != p_soa) ? p_soa->p_length[element_1] : p_obj_1->length) - 1u;
 
-          size_t const e2_start = p_objs[element_2].position;
-          size_t const e2_end = e2_start + p_objs[element_2].length-1u;
+          size_t const e2_start = (NULL != p_soa) ? p_soa->p_position[element_2] : p_obj_2->position;
+          size_t const e2_end = e2_start + ((NULL != p_soa) ? p_soa->p_length[element_2] : p_obj_2->length) - 1u;
 
           // Check if either end is within the other
           b_ret_val = ((e1_start <= e2_start) && (e1_end >= e2_start)) ||
@@ -401,23 +867,23 @@ bool ws2812b_draw_get_obj_overlap(size_t const element_1,
 /// Effect that transitions through all RGB colors
 /// Call more often than the update_rate_ms
 ///
+/// @param p_ctx   The draw context
 /// @param element The object element to update
 /// @param update_rate_ms How often to update to colors
 /// @param step    How much to increment the color per update time
 ///                The lower the number the smooth the transitions
-void ws2812b_draw_effect_transition_colors(size_t const element,
-                                           uint32_t const update_rate_ms,
-                                           uint32_t const step)
+void ws2812b_draw_ctx_effect_transition_colors(ws2812b_draw_ctx_t * const p_ctx,
+                                               size_t const element,
+                                               uint32_t const update_rate_ms,
+                                               uint32_t const step)
 {
-    static uint8_t red = WS2812_POWER_VAL;
-    static uint8_t green = 0x0;
-    static uint8_t blue = 0x0;
-
-    if( (NULL != p_objs) &&
-        (element < objects_count) )
+    if(NULL != ws2812b_draw_get_obj(p_ctx, element))
     {
-        if( 0 == (tick_ms_elapsed % update_rate_ms))
+        if( 0 == (p_ctx->tick_ms_elapsed % update_rate_ms))
         {
+            uint8_t red = p_ctx->effect_red;
+            uint8_t green = p_ctx->effect_green;
+            uint8_t blue = p_ctx->effect_blue;
 
             // Transition logic
             if (red == WS2812_POWER_VAL && green < WS2812_POWER_VAL && blue == 0)
@@ -450,116 +916,412 @@ void ws2812b_draw_effect_transition_colors(size_t const element,
             green = (WS2812_POWER_VAL < green) ? WS2812_POWER_VAL : green;
             blue =  (WS2812_POWER_VAL < blue)  ? WS2812_POWER_VAL : blue;
 
-            ws2812b_draw_set_color(element, red, green, blue);
+            p_ctx->effect_red = red;
+            p_ctx->effect_green = green;
+            p_ctx->effect_blue = blue;
+
+            ws2812b_draw_ctx_set_color(p_ctx, element, red, green, blue);
         }
     }
 }
 
-/// Up the position of a moving object
+/// Get the context used by the functions that don't take one
 ///
-/// If an object is moving in a direction, this function
-/// will update the position / length based on the objects configuration
+/// Lets apps mix the ws2812b_draw_ctx_... functions with the plain ones.
 ///
-/// @param element The object element to update
-static void ws2812b_update_position(size_t const element)
+/// @return The built in draw context
+ws2812b_draw_ctx_t * ws2812b_draw_get_default_ctx(void)
 {
-    bool b_hit_end = false;
-    ws2812b_draw_object_t * p_obj = &p_objs[element];
+    return &default_ctx;
+}
 
-    size_t led_count = (int32_t)p_strip->led_count;
+/// Draw the objects, update the tick counter
+///
+/// @param tick_ms The amount of ticks in milli-seconds that have elapsed
+void ws2812b_draw(int32_t tick_ms)
+{
+    ws2812b_draw_ctx_draw(&default_ctx, tick_ms);
+}
 
-    bool b_ok = (DIRECTION_NOT_MOVING != p_obj->direction) &&
-                (0 < p_obj->increment_rate_ms) &&
-                ws2812b_position_in_range(led_count, p_obj->start_position) &&
-                ws2812b_position_in_range(led_count, p_obj->end_position);
+/// Draw the objects at an absolute time, see ws2812b_draw_ctx_draw_at
+///
+/// @param now_ms Time in milli-seconds since the objects were set up
+///
+/// @return Milli-seconds until the next change, WS2812B_DRAW_FOREVER if none
+int32_t ws2812b_draw_at(int32_t const now_ms)
+{
+    return ws2812b_draw_ctx_draw_at(&default_ctx, now_ms);
+}
 
-    if(b_ok)
-    {
-        // Can we increment/decrement?
-        b_ok = (0 == (tick_ms_elapsed % p_obj->increment_rate_ms));
+/// Update internal pointers to use the instances specified here
+///
+/// @param p_objects_store  The draw objects to initialize
+/// @param p_instance       The instance to the ws2812b_t data
+void ws2812b_draw_setup(ws2812b_draw_objects_store_t * const p_objects_store,
+                        ws2812b_t * const p_instance)
+{
+    ws2812b_draw_ctx_setup(&default_ctx, p_objects_store, p_instance);
+}
+
+/// Select where objects are drawn, see ws2812b_draw_ctx_set_mode
+///
+/// @param mode The draw mode to use
+void ws2812b_draw_set_mode(ws2812b_draw_mode_t const mode)
+{
+    ws2812b_draw_ctx_set_mode(&default_ctx, mode);
+}
+
+/// Give the built in context an event schedule, see ws2812b_draw_ctx_set_events
+///
+/// @param p_events     One event per object, NULL to check every object every tick
+/// @param events_count The number of events in p_events
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_draw_set_events(ws2812b_draw_event_t * const p_events, size_t const events_count)
+{
+    return ws2812b_draw_ctx_set_events(&default_ctx, p_events, events_count);
+}
+
+/// Only draw the LEDs that change, see ws2812b_draw_ctx_set_damage
+///
+/// @param p_paint     One paint per object, NULL to draw the whole strip every time
+/// @param paint_count The number of paints in p_paint
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_draw_set_damage(ws2812b_draw_paint_t * const p_paint, size_t const paint_count)
+{
+    return ws2812b_draw_ctx_set_damage(&default_ctx, p_paint, paint_count);
+}
+
+/// Get the LEDs the last draw changed, see ws2812b_draw_ctx_get_damage
+///
+/// @param p_span Where to store the changed LEDs, 0 based, end not included
+///
+/// @return TRUE if the last draw changed any LED, FALSE otherwise
+bool ws2812b_draw_get_damage(ws2812b_span_t * const p_span)
+{
+    return ws2812b_draw_ctx_get_damage(&default_ctx, p_span);
+}
+
+/// Initialize all objects to not draw
+void ws2812b_draw_clear_objects()
+{
+    ws2812b_draw_ctx_clear_objects(&default_ctx);
+}
+
+/// Set object property action, see ws2812b_draw_ctx_set_action
+///
+/// @param element The object element to update
+/// @param action  The property value to set
+void ws2812b_draw_set_action(size_t const element, ws2812b_draw_action_t action)
+{
+    ws2812b_draw_ctx_set_action(&default_ctx, element, action);
+}
+
+/// Set object property direction, see ws2812b_draw_ctx_set_direction
+///
+/// @param element The object element to update
+/// @param direction  The property value to set
+void ws2812b_draw_set_direction(size_t const element, ws2812b_direction_t direction)
+{
+    ws2812b_draw_ctx_set_direction(&default_ctx, element, direction);
+}
+
+/// Set object property blink state, see ws2812b_draw_ctx_set_blink_state
+///
+/// @param element The object element to update
+/// @param state  The property value to set
+void ws2812b_draw_set_blink_state(size_t const element, ws2812b_blink_state_t const state)
+{
+    ws2812b_draw_ctx_set_blink_state(&default_ctx, element, state);
+}
+
+/// Set object property blink rate, see ws2812b_draw_ctx_set_blink_rate
+///
+/// @param element The object element to update
+/// @param rate_ms  The property value to set
+void ws2812b_draw_set_blink_rate(size_t const element, int32_t const rate_ms)
+{
+    ws2812b_draw_ctx_set_blink_rate(&default_ctx, element, rate_ms);
+}
+
+/// Set object property duration, see ws2812b_draw_ctx_set_duration
+///
+/// @param element The object element to update
+/// @param duration  The property value to set
+void ws2812b_draw_set_duration(size_t const element, int32_t const duration_ms)
+{
+    ws2812b_draw_ctx_set_duration(&default_ctx, element, duration_ms);
+}
+
+/// Set object property length, see ws2812b_draw_ctx_set_length
+///
+/// @param element The object element to update
+/// @param length  The property value to set
+void ws2812b_draw_set_length(size_t const element, size_t const length)
+{
+    ws2812b_draw_ctx_set_length(&default_ctx, element, length);
+}
+
+/// Set object property increment rate, see ws2812b_draw_ctx_set_increment_rate
+///
+/// @param element The object element to update
+/// @param rate_ms  The property value to set
+void ws2812b_draw_set_increment_rate(size_t const element, size_t const rate_ms)
+{
+    ws2812b_draw_ctx_set_increment_rate(&default_ctx, element, rate_ms);
+}
+
+/// Set object property position, see ws2812b_draw_ctx_set_position
+///
+/// @param element The object element to update
+/// @param position  The property value to set
+void ws2812b_draw_set_position(size_t const element, size_t const position)
+{
+    ws2812b_draw_ctx_set_position(&default_ctx, element, position);
+}
+
+/// Set object property color (RGB), see ws2812b_draw_ctx_set_color
+///
+/// @param element The object element to update
+/// @param red    The property value to set
+/// @param green  The property value to set
+/// @param blue   The property value to set
+void ws2812b_draw_set_color(size_t const element,
+                    uint8_t const red,
+                    uint8_t const green,
+                    uint8_t const blue)
+{
+    ws2812b_draw_ctx_set_color(&default_ctx, element, red, green, blue);
+}
+
+/// Set object property start position, see ws2812b_draw_ctx_set_start_position
+///
+/// @param element The object element to update
+/// @param position The property value to set
+void ws2812b_draw_set_start_position(size_t const element, size_t const position)
+{
+    ws2812b_draw_ctx_set_start_position(&default_ctx, element, position);
+}
+
+/// Set object property end position, see ws2812b_draw_ctx_set_end_position
+///
+/// @param element The object element to update
+/// @param position The property value to set
+void ws2812b_draw_set_end_position(size_t const element, size_t const position)
+{
+    ws2812b_draw_ctx_set_end_position(&default_ctx, element, position);
+}
+
+/// Set object property grow, see ws2812b_draw_ctx_set_grow
+///
+/// @param element The object element to update
+/// @param b_grow The property value to set
+void ws2812b_draw_set_grow(size_t const element, bool const b_grow)
+{
+    ws2812b_draw_ctx_set_grow(&default_ctx, element, b_grow);
+}
+
+/// Set object property reverse, see ws2812b_draw_ctx_set_reverse
+///
+/// @param element The object element to update
+/// @param b_resverse The property value to set
+void ws2812b_draw_set_reverse(size_t const element, bool const b_reverse)
+{
+    ws2812b_draw_ctx_set_reverse(&default_ctx, element, b_reverse);
+}
+
+/// Get if the position hit the start position or end position
+///
+/// @param element The object element to update
+///
+/// @return True if the current position equals the start or end position
+bool ws2812b_draw_get_hit(size_t const element)
+{
+    return ws2812b_draw_ctx_get_hit(&default_ctx, element);
+}
 
-        // Update direction if moving
-        if(b_ok)
+/// Get if the direction of the object
+///
+/// @param element The object element to update
+///
+/// @return The direction of the object
+ws2812b_direction_t ws2812b_draw_get_direction(size_t const element)
+{
+    return ws2812b_draw_ctx_get_direction(&default_ctx, element);
+}
+
+/// Check if two objects overlap at any point
+///
+/// @param element_1 The element for an object to check
+/// @param element_2 The element for an object to check
+///
+/// @return True if overlap, false otherwise
+bool ws2812b_draw_get_obj_overlap(size_t const element_1,
+                                  size_t const element_2)
+{
+    return ws2812b_draw_ctx_get_obj_overlap(&default_ctx, element_1, element_2);
+}
+
+/// Effect that transitions through all RGB colors
+/// Call more often than the update_rate_ms
+///
+/// @param element The object element to update
+/// @param update_rate_ms How often to update to colors
+/// @param step    How much to increment the color per update time
+///                The lower the number the smooth the transitions
+void ws2812b_draw_effect_transition_colors(size_t const element,
+                                           uint32_t const update_rate_ms,
+                                           uint32_t const step)
+{
+    ws2812b_draw_ctx_effect_transition_colors(&default_ctx, element, update_rate_ms, step);
+}
+
+/// Get an object of a context with bounds checking
+///
+/// @param p_ctx   The draw context
+/// @param element The object element
+///
+/// @return Pointer to the object, NULL if there is no such object
+static ws2812b_draw_object_t * ws2812b_draw_get_obj(ws2812b_draw_ctx_t const * const p_ctx,
+                                                    size_t const element)
+{
+    ws2812b_draw_object_t * p_obj = NULL;
+
+    if( (NULL != p_ctx) &&
+        (NULL != p_ctx->p_objs) &&
+        (element < p_ctx->objects_count) )
+      {
+          p_obj = &p_ctx->p_objs[element];
+      }
+
+    return p_obj;
+}
+
+/// Up the position of a moving object
+///
+/// If an object is moving in a direction, this function
+/// will update the position / length based on the objects configuration
+///
+/// @param p_ctx   The draw context
+/// @param element The object element to update
+static void ws2812b_update_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element)
+{
+    ws2812b_draw_object_t const * p_obj = &p_ctx->p_objs[element];
+
+    // Can we increment/decrement?
+    if( ws2812b_can_move(p_ctx, p_obj) &&
+        (0 == (p_ctx->tick_ms_elapsed % p_obj->increment_rate_ms)) )
+    {
+        ws2812b_step_position(p_ctx, element);
+    }
+}
+
+/// Check if an object moves on its increment rate
+///
+/// @param p_ctx The draw context
+/// @param p_obj The object to check
+///
+/// @return True if the object is moving, false otherwise
+static bool ws2812b_can_move(ws2812b_draw_ctx_t const * const p_ctx,
+                             ws2812b_draw_object_t const * const p_obj)
+{
+    size_t const led_count = p_ctx->p_strip->led_count;
+
+    return (DIRECTION_NOT_MOVING != p_obj->direction) &&
+           (0 < p_obj->increment_rate_ms) &&
+           ws2812b_position_in_range(led_count, p_obj->start_position) &&
+           ws2812b_position_in_range(led_count, p_obj->end_position);
+}
+
+/// Move an object one step in its direction
+///
+/// @param p_ctx   The draw context
+/// @param element The object element to update
+static void ws2812b_step_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element)
+{
+    bool b_hit_end = false;
+    ws2812b_draw_object_t * p_obj = &p_ctx->p_objs[element];
+
+    size_t led_count = (int32_t)p_ctx->p_strip->led_count;
+
+    if(DIRECTION_FORWARD == p_obj->direction)
+    {
+        // Keep position, move length
+        if(p_obj->b_grow)
         {
-            if(DIRECTION_FORWARD == p_obj->direction)
-            {
-                // Keep position, move length
-                if(p_obj->b_grow)
-                {
-                    p_obj->position = p_obj->start_position;
-                    ++p_obj->length;
+            p_obj->position = p_obj->start_position;
+            ++p_obj->length;
 
-                    size_t const curr_pos =
-                          p_obj->position + p_obj->length;
-                    size_t const end_length =
-                        p_obj->end_position - p_obj->start_position;
+            size_t const curr_pos =
+                  p_obj->position + p_obj->length;
+            size_t const end_length =
+                p_obj->end_position - p_obj->start_position;
 
-                    p_obj->length =
-                        ws2812b_position_in_range(led_count, curr_pos) ?
-                            p_obj->length : end_length;
+            p_obj->length =
+                ws2812b_position_in_range(led_count, curr_pos) ?
+                    p_obj->length : end_length;
 
-                    if(p_obj->end_position <= curr_pos)
-                    {
-                        p_obj->direction = p_obj->b_reverse ?
-                            DIRECTION_REVERSE : DIRECTION_FORWARD;
+            if(p_obj->end_position <= curr_pos)
+            {
+                p_obj->direction = p_obj->b_reverse ?
+                    DIRECTION_REVERSE : DIRECTION_FORWARD;
 
-                        b_hit_end = true;
-                    }
-                }
-                // Keep length, move position
-                else
-                {
-                    ++p_obj->position;
-
-                    p_obj->position =
-                        ws2812b_position_in_range(led_count, p_obj->position) ?
-                            p_obj->position : p_obj->end_position;
-
-                    if(p_obj->end_position <= p_obj->position)
-                    {
-                        p_obj->direction = p_obj->b_reverse ?
-                            DIRECTION_REVERSE : DIRECTION_FORWARD;
-                        b_hit_end = true;
-                    }
-                }
+                b_hit_end = true;
             }
-            else if(DIRECTION_REVERSE == p_obj->direction)
+        }
+        // Keep length, move position
+        else
+        {
+            ++p_obj->position;
+
+            p_obj->position =
+                ws2812b_position_in_range(led_count, p_obj->position) ?
+                    p_obj->position : p_obj->end_position;
+
+            if(p_obj->end_position <= p_obj->position)
             {
-                // Keep position, move length
-                if(p_obj->b_grow)
-                {
-                    p_obj->position = p_obj->start_position;
-                    --p_obj->length;
+                p_obj->direction = p_obj->b_reverse ?
+                    DIRECTION_REVERSE : DIRECTION_FORWARD;
+                b_hit_end = true;
+            }
+        }
+    }
+    else if(DIRECTION_REVERSE == p_obj->direction)
+    {
+        // Keep position, move length
+        if(p_obj->b_grow)
+        {
+            p_obj->position = p_obj->start_position;
+            --p_obj->length;
 
-                    size_t curr_pos = (p_obj->position + p_obj->length);
+            size_t curr_pos = (p_obj->position + p_obj->length);
 
-                    p_obj->length =
-                        ws2812b_position_in_range(led_count, curr_pos) ?
-                            p_obj->length : 0;
+            p_obj->length =
+                ws2812b_position_in_range(led_count, curr_pos) ?
+                    p_obj->length : 0;
 
-                    if(p_obj->start_position >= curr_pos)
-                    {
-                        p_obj->direction = p_obj->b_reverse ?
-                            DIRECTION_FORWARD : DIRECTION_REVERSE;
-                        b_hit_end = true;
-                    }
-                }
-                // Keep length, move position
-                else
-                {
-                    --p_obj->position;
-
-                    p_obj->position =
-                        ws2812b_position_in_range(led_count, p_obj->position) ?
-                            p_obj->position : p_obj->start_position;
-
-                    if(p_obj->start_position >= p_obj->position)
-                    {
-                        p_obj->direction = p_obj->b_reverse ?
-                            DIRECTION_FORWARD : DIRECTION_REVERSE;
-                        b_hit_end = true;
-                    }
-                }
+            if(p_obj->start_position >= curr_pos)
+            {
+                p_obj->direction = p_obj->b_reverse ?
+                    DIRECTION_FORWARD : DIRECTION_REVERSE;
+                b_hit_end = true;
+            }
+        }
+        // Keep length, move position
+        else
+        {
+            --p_obj->position;
+
+            p_obj->position =
+                ws2812b_position_in_range(led_count, p_obj->position) ?
+                    p_obj->position : p_obj->start_position;
+
+            if(p_obj->start_position >= p_obj->position)
+            {
+                p_obj->direction = p_obj->b_reverse ?
+                    DIRECTION_FORWARD : DIRECTION_REVERSE;
+                b_hit_end = true;
             }
         }
     }
@@ -569,6 +1331,59 @@ static void ws2812b_update_position(size_t const element)
     {
         p_obj->b_hit_end = b_hit_end;
     }
+
+    if(NULL != p_ctx->p_soa)
+    {
+        p_ctx->p_soa->p_position[element] = p_obj->position;
+        p_ctx->p_soa->p_length[element] = p_obj->length;
+        p_ctx->p_soa->p_direction[element] = (uint8_t)p_obj->direction;
+    }
+}
+
+/// Move an object several steps in its direction
+///
+/// Moves repeat once an object is back at a position, length and direction
+/// it had before, so after a long gap only the steps that are not a whole
+/// number of those cycles are done.  Finding the cycle (Brent's method)
+/// takes at most a few passes over the strip.  A hit in skipped cycles was
+/// already seen while finding the cycle, so ws2812b_draw_ctx_get_hit is
+/// the same as doing every step.
+///
+/// @param p_ctx   The draw context
+/// @param element The object element to update
+/// @param steps   The number of steps to move
+static void ws2812b_step_position_x(ws2812b_draw_ctx_t * const p_ctx,
+                                    size_t const element,
+                                    int64_t steps)
+{
+    ws2812b_draw_object_t const * const p_obj = &p_ctx->p_objs[element];
+    size_t seen_position = p_obj->position;
+    size_t seen_length = p_obj->length;
+    ws2812b_direction_t seen_direction = p_obj->direction;
+    int64_t power = 1;
+    int64_t cycle = 0;
+
+    while(0 < steps)
+    {
+        ws2812b_step_position(p_ctx, element);
+        --steps;
+        ++cycle;
+
+        if( (seen_position == p_obj->position) &&
+            (seen_length == p_obj->length) &&
+            (seen_direction == p_obj->direction) )
+        {
+            steps %= cycle;
+        }
+        else if(cycle == power)
+        {
+            seen_position = p_obj->position;
+            seen_length = p_obj->length;
+            seen_direction = p_obj->direction;
+            power *= 2;
+            cycle = 0;
+        }
+    }
 }
 
 /// Check if a position is in the range of the current led strip
@@ -580,43 +1395,211 @@ static bool ws2812b_position_in_range(size_t const led_count, size_t const posit
     return (led_count >= position); //no need to worry about negative
 }
 
+/// Update the blink state of an object
+///
+/// @param p_ctx   The draw context
+/// @param element The object element to update
+static void ws2812b_update_blink(ws2812b_draw_ctx_t * const p_ctx, size_t const element)
+{
+    ws2812b_draw_object_t * p_obj = &p_ctx->p_objs[element];
+
+    bool b_expired = (p_ctx->tick_ms_elapsed >= p_obj->duration_ms);
+
+    // Only blink if drawn and duration specified
+    if( !b_expired &&
+        ((DRAW_ACTION_BLINK_BLACK == p_obj->action) ||
+         (DRAW_ACTION_BLINK_TRANSPARENT == p_obj->action)) )
+    {
+        // Update blink state based on blink rate, a rate of 0 never blinks
+        if( (0 != p_obj->blink_rate_ms) &&
+            (0 == (p_ctx->tick_ms_elapsed % p_obj->blink_rate_ms)) )
+        {
+            ws2812b_toggle_blink(p_ctx, element);
+        }
+    }
+}
+
+/// Toggle the blink state of an object on/off
+///
+/// @param p_ctx   The draw context
+/// @param element The object element to update
+static void ws2812b_toggle_blink(ws2812b_draw_ctx_t * const p_ctx, size_t const element)
+{
+    ws2812b_draw_object_t * const p_obj = &p_ctx->p_objs[element];
+
+    p_obj->blink_state =
+        (BLINK_STATE_ON == p_obj->blink_state) ?
+            BLINK_STATE_OFF : BLINK_STATE_ON;
+
+    if(NULL != p_ctx->p_soa)
+    {
+        p_ctx->p_soa->p_blink_state[element] = (uint8_t)p_obj->blink_state;
+    }
+}
+
+/// Update the blink state of every object from the dense arrays
+///
+/// Same as ws2812b_update_blink for each object, but only reads the
+/// bytes it needs from ws2812b_draw_soa_t.
+///
+/// @param p_ctx The draw context
+static void ws2812b_soa_update_blinks(ws2812b_draw_ctx_t * const p_ctx)
+{
+    ws2812b_draw_soa_t const * const p_soa = p_ctx->p_soa;
+    int32_t const elapsed_ms = p_ctx->tick_ms_elapsed;
+    size_t const count = p_ctx->objects_count;
+
+    for(size_t idx = 0; idx < count; idx++)
+    {
+        uint8_t const action = p_soa->p_action[idx];
+        int32_t const rate_ms = p_soa->p_blink_rate_ms[idx];
+
+        if( ((DRAW_ACTION_BLINK_BLACK == action) ||
+             (DRAW_ACTION_BLINK_TRANSPARENT == action)) &&
+            (elapsed_ms < p_soa->p_duration_ms[idx]) &&
+            (0 != rate_ms) &&
+            (0 == (elapsed_ms % rate_ms)) )
+        {
+            ws2812b_toggle_blink(p_ctx, idx);
+        }
+    }
+}
+
+/// Move every object that is due from the dense arrays
+///
+/// Same as ws2812b_update_position for each object, objects that are
+/// not moving only cost a byte.
+///
+/// @param p_ctx The draw context
+static void ws2812b_soa_update_positions(ws2812b_draw_ctx_t * const p_ctx)
+{
+    ws2812b_draw_soa_t const * const p_soa = p_ctx->p_soa;
+    size_t const count = p_ctx->objects_count;
+
+    for(size_t idx = 0; idx < count; idx++)
+    {
+        if( (DIRECTION_NOT_MOVING != p_soa->p_direction[idx]) &&
+            (0 < p_soa->p_increment_rate_ms[idx]) &&
+            (0 == (p_ctx->tick_ms_elapsed % p_soa->p_increment_rate_ms[idx])) &&
+            ws2812b_can_move(p_ctx, &p_ctx->p_objs[idx]) )
+        {
+            ws2812b_step_position(p_ctx, idx);
+        }
+    }
+}
+
+/// Copy the hot fields of an object to the dense arrays
+///
+/// @param p_ctx   The draw context
+/// @param element The object element to copy
+static void ws2812b_soa_sync(ws2812b_draw_ctx_t * const p_ctx, size_t const element)
+{
+    ws2812b_draw_soa_t * const p_soa = p_ctx->p_soa;
+    ws2812b_draw_object_t const * const p_obj = &p_ctx->p_objs[element];
+
+    p_soa->p_action[element] = (uint8_t)p_obj->action;
+    p_soa->p_blink_state[element] = (uint8_t)p_obj->blink_state;
+    p_soa->p_direction[element] = (uint8_t)p_obj->direction;
+    p_soa->p_blink_rate_ms[element] = p_obj->blink_rate_ms;
+    p_soa->p_duration_ms[element] = p_obj->duration_ms;
+    p_soa->p_increment_rate_ms[element] = p_obj->increment_rate_ms;
+    p_soa->p_position[element] = p_obj->position;
+    p_soa->p_length[element] = p_obj->length;
+    p_soa->p_color[element] = WS2812B_DRAW_COLOR(p_obj->red, p_obj->green, p_obj->blue);
+}
+
 /// Draw the objects
 ///
-/// @param element The object element to draw
-static void ws2812b_draw_object(size_t const element)
+/// @param p_ctx      The draw context
+/// @param p_instance The strip to draw on
+/// @param element    The object element to draw
+static void ws2812b_draw_object(ws2812b_draw_ctx_t const * const p_ctx,
+                                ws2812b_t * const p_instance,
+                                size_t const element)
 {
-    if(objects_count > element)
+    ws2812b_draw_paint_t paint;
+
+    if(ws2812b_draw_get_paint(p_ctx, p_instance, element, &paint))
     {
-        ws2812b_draw_object_t * p_obj = &p_objs[element];
+        ws2812b_draw_fill(p_ctx,
+                          p_instance,
+                          paint.position,
+                          paint.length,
+                          (uint8_t)(paint.color >> 16),
+                          (uint8_t)(paint.color >> 8),
+                          (uint8_t)paint.color);
+    }
+}
+
+/// Work out what an object paints on a strip right now
+///
+/// @param p_ctx      The draw context
+/// @param p_instance The strip the object is drawn on
+/// @param element    The object element
+/// @param p_paint    Where to store the paint, cleared if nothing is painted
+///
+/// @return TRUE if the object paints LEDs, FALSE otherwise
+static bool ws2812b_draw_get_paint(ws2812b_draw_ctx_t const * const p_ctx,
+                                   ws2812b_t const * const p_instance,
+                                   size_t const element,
+                                   ws2812b_draw_paint_t * const p_paint)
+{
+    p_paint->position = 0u;
+    p_paint->length = 0u;
+    p_paint->color = 0u;
+    p_paint->b_painted = false;
 
-        if(DRAW_ACTION_NO_DRAW != p_obj->action)
+    if(p_ctx->objects_count > element)
+    {
+        ws2812b_draw_soa_t const * const p_soa = p_ctx->p_soa;
+        ws2812b_draw_action_t action;
+        ws2812b_blink_state_t blink_state;
+        int32_t duration_ms;
+        size_t position;
+        size_t length;
+        uint32_t color;
+
+        // Only the fields drawing needs, from the dense arrays if there are any
+        if(NULL != p_soa)
+        {
+            action = (ws2812b_draw_action_t)p_soa->p_action[element];
+            blink_state = (ws2812b_blink_state_t)p_soa->p_blink_state[element];
+            duration_ms = p_soa->p_duration_ms[element];
+            position = p_soa->p_position[element];
+            length = p_soa->p_length[element];
+            color = p_soa->p_color[element];
+        }
+        else
+        {
+            ws2812b_draw_object_t const * p_obj = &p_ctx->p_objs[element];
+
+            action = p_obj->action;
+            blink_state = p_obj->blink_state;
+            duration_ms = p_obj->duration_ms;
+            position = p_obj->position;
+            length = p_obj->length;
+            color = WS2812B_DRAW_COLOR(p_obj->red, p_obj->green, p_obj->blue);
+        }
+
+        if(DRAW_ACTION_NO_DRAW != action)
         {
             bool b_draw = false;
 
-            bool b_expired = (tick_ms_elapsed >= p_obj->duration_ms) ;
+            bool b_expired = (p_ctx->tick_ms_elapsed >= duration_ms) ;
 
             // Only draw if duration specified
             if(!b_expired)
             {
                 // Draw the object
-                if(DRAW_ACTION_SOLID == p_obj->action)
+                if(DRAW_ACTION_SOLID == action)
                 {
                     b_draw = true;
                 }
-                // If blink, check if it's time to blink
-                else if( (DRAW_ACTION_BLINK_BLACK == p_obj->action) ||
-                         (DRAW_ACTION_BLINK_TRANSPARENT == p_obj->action) )
+                // If blink, the state was updated by ws2812b_update_blink
+                else if( (DRAW_ACTION_BLINK_BLACK == action) ||
+                         (DRAW_ACTION_BLINK_TRANSPARENT == action) )
                 {
-                    // Update blink state based on blink rate
-                    if(0 == (tick_ms_elapsed % p_obj->blink_rate_ms))
-                    {
-                        // Toggle on/off
-                        p_obj->blink_state =
-                            (BLINK_STATE_ON == p_obj->blink_state) ?
-                                BLINK_STATE_OFF : BLINK_STATE_ON;
-                    }
-
-                    b_draw = (BLINK_STATE_ON == p_obj->blink_state);
+                    b_draw = (BLINK_STATE_ON == blink_state);
                 }
                 // Don't draw anything
                 else
@@ -624,29 +1607,429 @@ static void ws2812b_draw_object(size_t const element)
                     b_draw = false;
                 }
 
-                if(b_draw)
+                // Only fill in black if not wanting to show any data
+                // Check if transparent blink, if so, what ever was in
+                // this led spot will stay
+                p_paint->b_painted = b_draw || (DRAW_ACTION_BLINK_TRANSPARENT != action);
+                p_paint->color = b_draw ? color : 0u;
+
+                // Objects that don't fit on the strip are not drawn at all
+                if( (0u == position) ||
+                    (0u == length) ||
+                    (position - 1u > p_instance->led_count) ||
+                    (length > (p_instance->led_count - (position - 1u))) )
+                {
+                    p_paint->b_painted = false;
+                }
+
+                if(p_paint->b_painted)
                 {
-                    ws2812b_data_set_x(p_strip,
-                                       p_obj->position,
-                                       p_obj->length,
-                                       p_obj->red,
-                                       p_obj->green,
-                                       p_obj->blue);
+                    p_paint->position = position;
+                    p_paint->length = length;
                 }
                 else
                 {
-                    // Only fill in black if not wanting to show any data
-                    // Check if transparent blink, if so, what ever was in
-                    // this led spot will stay
-                    if((DRAW_ACTION_BLINK_TRANSPARENT != p_obj->action))
-                    {
-                        ws2812b_data_set_x(p_strip,
-                                           p_obj->position,
-                                           p_obj->length,
-                                           WS2812B_BLACK);
-                    }
+                    p_paint->color = 0u;
+                }
+            }
+        }
+    }
+
+    return p_paint->b_painted;
+}
+
+/// Draw only the LEDs whose contents changed since the last draw
+///
+/// Each object's paint is compared with the one kept from the last draw.
+/// The LEDs an object left or now covers are damaged, every damaged span
+/// is cleared and the objects over it are drawn again in order, so later
+/// objects still cover earlier ones and transparent blinks show what is
+/// under them.
+///
+/// @param p_ctx The draw context, with a paint per object
+static void ws2812b_draw_damage(ws2812b_draw_ctx_t * const p_ctx)
+{
+    ws2812b_t * const p_strip = p_ctx->p_strip;
+    ws2812b_draw_paint_t * const p_last = p_ctx->p_paint;
+    ws2812b_span_t spans[WS2812B_DIRTY_SPAN_MAX];
+    size_t span_count = 0u;
+
+    if(p_ctx->b_damage_all)
+    {
+        spans[0].start = 0u;
+        spans[0].end = p_strip->led_count;
+        span_count = 1u;
+        p_ctx->b_damage_all = false;
+    }
+
+    for(size_t idx = 0; idx < p_ctx->objects_count; idx++)
+    {
+        ws2812b_draw_paint_t paint;
+
+        ws2812b_draw_get_paint(p_ctx, p_strip, idx, &paint);
+
+        if( (paint.b_painted != p_last[idx].b_painted) ||
+            (paint.position != p_last[idx].position) ||
+            (paint.length != p_last[idx].length) ||
+            (paint.color != p_last[idx].color) )
+        {
+            if(p_last[idx].b_painted)
+            {
+                ws2812b_data_span_add(spans, &span_count,
+                                      p_last[idx].position - 1u,
+                                      p_last[idx].position - 1u + p_last[idx].length);
+            }
+
+            if(paint.b_painted)
+            {
+                ws2812b_data_span_add(spans, &span_count,
+                                      paint.position - 1u,
+                                      paint.position - 1u + paint.length);
+            }
+
+            p_last[idx] = paint;
+        }
+    }
+
+    p_ctx->damage.start = 0u;
+    p_ctx->damage.end = 0u;
+
+    if(0u < span_count)
+    {
+        p_ctx->damage = spans[0];
+
+        for(size_t span = 0; span < span_count; span++)
+        {
+            p_ctx->damage.start = (spans[span].start < p_ctx->damage.start) ?
+                spans[span].start : p_ctx->damage.start;
+            p_ctx->damage.end = (spans[span].end > p_ctx->damage.end) ?
+                spans[span].end : p_ctx->damage.end;
+
+            ws2812b_draw_fill(p_ctx, p_strip,
+                              spans[span].start + 1u,
+                              spans[span].end - spans[span].start,
+                              WS2812B_BLACK);
+        }
+
+        for(size_t idx = 0; idx < p_ctx->objects_count; idx++)
+        {
+            ws2812b_draw_paint_t const * const p_paint = &p_last[idx];
+            size_t const obj_start = p_paint->position - 1u;
+            size_t const obj_end = obj_start + p_paint->length;
+            bool const b_damaged = p_paint->b_painted &&
+                                   (obj_start < p_ctx->damage.end) &&
+                                   (p_ctx->damage.start < obj_end);
+
+            for(size_t span = 0; (span < span_count) && b_damaged; span++)
+            {
+                size_t const start = (obj_start > spans[span].start) ? obj_start : spans[span].start;
+                size_t const end = (obj_end < spans[span].end) ? obj_end : spans[span].end;
+
+                if(start < end)
+                {
+                    ws2812b_draw_fill(p_ctx, p_strip,
+                                      start + 1u,
+                                      end - start,
+                                      (uint8_t)(p_paint->color >> 16),
+                                      (uint8_t)(p_paint->color >> 8),
+                                      (uint8_t)p_paint->color);
                 }
             }
         }
     }
 }
+
+/// Draw the context objects onto its own strip
+///
+/// Only the damage when the context tracks it, otherwise everything.
+///
+/// @param p_ctx The draw context
+static void ws2812b_draw_repaint(ws2812b_draw_ctx_t * const p_ctx)
+{
+    if(NULL != p_ctx->p_paint)
+    {
+        ws2812b_draw_damage(p_ctx);
+    }
+    else
+    {
+        ws2812b_draw_ctx_render(p_ctx, p_ctx->p_strip);
+
+        p_ctx->damage.start = 0u;
+        p_ctx->damage.end = p_ctx->p_strip->led_count;
+    }
+}
+
+/// Fill a span of LEDs with a color for the context draw mode
+///
+/// @param p_ctx      The draw context
+/// @param p_instance The strip to draw on
+/// @param position   The first LED of the span (1 based)
+/// @param length     The number of LEDs in the span
+/// @param red        The red value
+/// @param green      The green value
+/// @param blue       The blue value
+static void ws2812b_draw_fill(ws2812b_draw_ctx_t const * const p_ctx,
+                              ws2812b_t * const p_instance,
+                              size_t const position,
+                              size_t const length,
+                              uint8_t const red,
+                              uint8_t const green,
+                              uint8_t const blue)
+{
+    if(DRAW_MODE_STREAM == p_ctx->mode)
+    {
+        uint8_t pattern[WS2812B_LED_PATTERN_MAX];
+
+        if(ws2812b_data_encode_color(p_instance, red, green, blue, pattern))
+        {
+            ws2812b_data_stream_fill(p_instance, position, length, pattern);
+        }
+    }
+    else
+    {
+        ws2812b_data_set_x(p_instance, position, length, red, green, blue);
+    }
+}
+
+/// Note an object was changed by a set function
+///
+/// Copies it to the dense arrays, draws again on the next tick and moves
+/// the object in the event schedule, if the context has them.
+///
+/// @param p_ctx   The draw context
+/// @param element The object element that changed
+static void ws2812b_draw_changed(ws2812b_draw_ctx_t * const p_ctx, size_t const element)
+{
+    ws2812b_draw_event_t * const p_events = p_ctx->p_events;
+
+    if(NULL != p_ctx->p_soa)
+    {
+        ws2812b_soa_sync(p_ctx, element);
+    }
+
+    if(NULL != p_events)
+    {
+        size_t const heap_idx = p_events[element].heap_idx;
+
+        p_ctx->b_redraw = true;
+
+        ws2812b_events_schedule(p_ctx, element);
+        ws2812b_events_sift_up(p_events, heap_idx);
+        ws2812b_events_sift_down(p_events, p_ctx->objects_count, p_events[element].heap_idx);
+    }
+}
+
+/// Work out the next events of an object from the current time
+///
+/// Blinks and moves stay on multiples of their rate, the same ticks
+/// they happen on without a schedule.  Does not reorder the heap.
+///
+/// @param p_ctx   The draw context
+/// @param element The object element to schedule
+static void ws2812b_events_schedule(ws2812b_draw_ctx_t * const p_ctx, size_t const element)
+{
+    ws2812b_draw_object_t const * const p_obj = &p_ctx->p_objs[element];
+    ws2812b_draw_event_t * const p_event = &p_ctx->p_events[element];
+    int64_t const now_ms = p_ctx->tick_ms_elapsed;
+
+    p_event->blink_ms = WS2812B_DRAW_NO_EVENT_MS;
+    p_event->step_ms = WS2812B_DRAW_NO_EVENT_MS;
+
+    if( ((DRAW_ACTION_BLINK_BLACK == p_obj->action) ||
+         (DRAW_ACTION_BLINK_TRANSPARENT == p_obj->action)) &&
+        (0 < p_obj->blink_rate_ms) )
+    {
+        int64_t const next_ms = ((now_ms / p_obj->blink_rate_ms) + 1) * p_obj->blink_rate_ms;
+
+        if(next_ms < p_obj->duration_ms)
+        {
+            p_event->blink_ms = (int32_t)next_ms;
+        }
+    }
+
+    if(ws2812b_can_move(p_ctx, p_obj))
+    {
+        int64_t const rate_ms = (int64_t)p_obj->increment_rate_ms;
+        int64_t const next_ms = ((now_ms / rate_ms) + 1) * rate_ms;
+
+        if(next_ms < WS2812B_DRAW_NO_EVENT_MS)
+        {
+            p_event->step_ms = (int32_t)next_ms;
+        }
+    }
+
+    p_event->key = ws2812b_events_key(p_ctx, element, p_ctx->events_key);
+}
+
+/// Get the key of the next event of an object
+///
+/// @param p_ctx     The draw context
+/// @param element   The object element
+/// @param after_key Only expiry after this key is an event
+///
+/// @return The event key, WS2812B_DRAW_NO_EVENT if none
+static int64_t ws2812b_events_key(ws2812b_draw_ctx_t const * const p_ctx,
+                                  size_t const element,
+                                  int64_t const after_key)
+{
+    ws2812b_draw_object_t const * const p_obj = &p_ctx->p_objs[element];
+    ws2812b_draw_event_t const * const p_event = &p_ctx->p_events[element];
+    int64_t key = WS2812B_DRAW_NO_EVENT;
+
+    if(WS2812B_DRAW_NO_EVENT_MS != p_event->blink_ms)
+    {
+        key = 2 * (int64_t)p_event->blink_ms;
+    }
+
+    if( (WS2812B_DRAW_NO_EVENT_MS != p_event->step_ms) &&
+        (((2 * (int64_t)p_event->step_ms) + 1) < key) )
+    {
+        key = (2 * (int64_t)p_event->step_ms) + 1;
+    }
+
+    // Expiring only needs a draw, ws2812b_draw_object checks the time
+    if( (DRAW_ACTION_NO_DRAW != p_obj->action) &&
+        (INT32_MAX != p_obj->duration_ms) &&
+        ((2 * (int64_t)p_obj->duration_ms) > after_key) &&
+        ((2 * (int64_t)p_obj->duration_ms) < key) )
+    {
+        key = 2 * (int64_t)p_obj->duration_ms;
+    }
+
+    return key;
+}
+
+/// Handle every event up to a key
+///
+/// @param p_ctx     The draw context
+/// @param limit_key Handle events with a key up to and including this one
+static void ws2812b_events_run(ws2812b_draw_ctx_t * const p_ctx, int64_t const limit_key)
+{
+    ws2812b_draw_event_t * const p_events = p_ctx->p_events;
+
+    while(p_events[p_events[0].heap].key <= limit_key)
+    {
+        size_t const element = p_events[0].heap;
+
+        ws2812b_events_run_object(p_ctx, element, limit_key);
+        ws2812b_events_sift_down(p_events, p_ctx->objects_count, 0u);
+    }
+
+    p_ctx->events_key = limit_key;
+}
+
+/// Handle the events of an object up to a key
+///
+/// Blinks and moves that were missed since the last tick are all done
+/// here, blinks only toggle for an odd count.
+///
+/// @param p_ctx     The draw context
+/// @param element   The object element with an event due
+/// @param limit_key Handle events with a key up to and including this one
+static void ws2812b_events_run_object(ws2812b_draw_ctx_t * const p_ctx,
+                                      size_t const element,
+                                      int64_t const limit_key)
+{
+    ws2812b_draw_object_t * const p_obj = &p_ctx->p_objs[element];
+    ws2812b_draw_event_t * const p_event = &p_ctx->p_events[element];
+
+    if( (WS2812B_DRAW_NO_EVENT_MS != p_event->blink_ms) &&
+        ((2 * (int64_t)p_event->blink_ms) <= limit_key) )
+    {
+        int64_t const rate_ms = p_obj->blink_rate_ms;
+        int64_t const last_ms = ((limit_key / 2) < p_obj->duration_ms) ?
+            (limit_key / 2) : ((int64_t)p_obj->duration_ms - 1);
+        int64_t const toggles = ((last_ms - p_event->blink_ms) / rate_ms) + 1;
+        int64_t const next_ms = p_event->blink_ms + (toggles * rate_ms);
+
+        if(0 != (toggles & 1))
+        {
+            ws2812b_toggle_blink(p_ctx, element);
+        }
+
+        p_event->blink_ms = (next_ms < p_obj->duration_ms) ?
+            (int32_t)next_ms : WS2812B_DRAW_NO_EVENT_MS;
+    }
+
+    if( (WS2812B_DRAW_NO_EVENT_MS != p_event->step_ms) &&
+        (((2 * (int64_t)p_event->step_ms) + 1) <= limit_key) )
+    {
+        int64_t const rate_ms = (int64_t)p_obj->increment_rate_ms;
+        int64_t const steps = ((((limit_key - 1) / 2) - p_event->step_ms) / rate_ms) + 1;
+        int64_t const next_ms = p_event->step_ms + (steps * rate_ms);
+
+        ws2812b_step_position_x(p_ctx, element, steps);
+
+        p_event->step_ms = (next_ms < WS2812B_DRAW_NO_EVENT_MS) ?
+            (int32_t)next_ms : WS2812B_DRAW_NO_EVENT_MS;
+    }
+
+    p_event->key = ws2812b_events_key(p_ctx, element, limit_key);
+    p_ctx->b_redraw = true;
+}
+
+/// Move an object up the event heap until its parent is not later
+///
+/// @param p_events The event schedule
+/// @param heap_idx The heap position of the object to move
+static void ws2812b_events_sift_up(ws2812b_draw_event_t * const p_events, size_t heap_idx)
+{
+    size_t const element = p_events[heap_idx].heap;
+    int64_t const key = p_events[element].key;
+
+    while(0u < heap_idx)
+    {
+        size_t const parent_idx = (heap_idx - 1u) / 2u;
+        size_t const parent = p_events[parent_idx].heap;
+
+        if(p_events[parent].key <= key)
+        {
+            break;
+        }
+
+        p_events[heap_idx].heap = parent;
+        p_events[parent].heap_idx = heap_idx;
+        heap_idx = parent_idx;
+    }
+
+    p_events[heap_idx].heap = element;
+    p_events[element].heap_idx = heap_idx;
+}
+
+/// Move an object down the event heap until its children are not earlier
+///
+/// @param p_events The event schedule
+/// @param count    The number of objects in the heap
+/// @param heap_idx The heap position of the object to move
+static void ws2812b_events_sift_down(ws2812b_draw_event_t * const p_events,
+                                     size_t const count,
+                                     size_t heap_idx)
+{
+    size_t const element = p_events[heap_idx].heap;
+    int64_t const key = p_events[element].key;
+
+    while(((2u * heap_idx) + 1u) < count)
+    {
+        size_t child_idx = (2u * heap_idx) + 1u;
+
+        if( ((child_idx + 1u) < count) &&
+            (p_events[p_events[child_idx + 1u].heap].key < p_events[p_events[child_idx].heap].key) )
+        {
+            child_idx++;
+        }
+
+        size_t const child = p_events[child_idx].heap;
+
+        if(key <= p_events[child].key)
+        {
+            break;
+        }
+
+        p_events[heap_idx].heap = child;
+        p_events[child].heap_idx = heap_idx;
+        heap_idx = child_idx;
+    }
+
+    p_events[heap_idx].heap = element;
+    p_events[element].heap_idx = heap_idx;
+}
@@ -11,13 +11,132 @@
 #include <stdint.h>
 
 
+/// No event pending, see ws2812b_draw_event_t
+#define WS2812B_DRAW_NO_EVENT INT64_MAX
+
+/// This struct holds the event schedule of one object
+///
+/// Given to a context with ws2812b_draw_ctx_set_events, one per object.
+/// Event keys are 2 * ms for blinks and expiry (handled before drawing)
+/// and 2 * ms + 1 for moves (handled after drawing), like a tick does.
+/// The heap fields hold a min-heap of the objects ordered by key.
+///
+/// The schedule makes a tick with nothing due O(1), but it only decides
+/// whether to draw.  Once any event fires the draw still goes over every
+/// object: O(objects) with damage tracking (ws2812b_draw_ctx_set_damage),
+/// which compares each object's paint and writes only changed LEDs, and
+/// O(objects + led_count) without it, which clears and draws the strip.
+typedef struct
+{
+    int64_t key;      ///< Key of the next event of the object, WS2812B_DRAW_NO_EVENT if none
+    int32_t blink_ms; ///< Time of the next blink toggle, INT32_MAX if none
+    int32_t step_ms;  ///< Time of the next position update, INT32_MAX if none
+    size_t  heap_idx; ///< Where the object is in the heap
+    size_t  heap;     ///< Heap slot, the object stored at this position of the heap
+} ws2812b_draw_event_t;
+
+/// This struct holds what one object painted on the strip
+///
+/// Given to a context with ws2812b_draw_ctx_set_damage, one per object.
+typedef struct
+{
+    size_t   position;  ///< First LED painted (1 based)
+    size_t   length;    ///< Number of LEDs painted
+    uint32_t color;     ///< Color painted, 0x00RRGGBB, 0 for a blink off in black
+    bool     b_painted; ///< The object painted anything
+} ws2812b_draw_paint_t;
+
+/// This struct holds one draw context, a strip and the objects drawn on it
+///
+/// Every context is independent, so several strips can be drawn from
+/// separate threads or cores with the ws2812b_draw_ctx_... functions.
+/// The ws2812b_draw_... functions without a context use a built in one.
+typedef struct
+{
+    ws2812b_t *             p_strip;         ///< The strip objects are drawn to
+    ws2812b_draw_object_t * p_objs;          ///< The objects to draw
+    ws2812b_draw_soa_t *    p_soa;           ///< Dense copy of the hot object fields, NULL if not used
+    size_t                  objects_count;   ///< The number of objects
+    int32_t                 tick_ms_elapsed; ///< Time drawn so far in ms
+    int32_t                 tick_ms_value;   ///< The last tick drawn in ms
+    ws2812b_draw_mode_t     mode;            ///< Where objects are drawn
+    uint8_t                 effect_red;      ///< Transition colors effect, red
+    uint8_t                 effect_green;    ///< Transition colors effect, green
+    uint8_t                 effect_blue;     ///< Transition colors effect, blue
+    ws2812b_draw_event_t *  p_events;        ///< Event schedule, NULL to check every object every tick
+    int64_t                 events_key;      ///< Events up to this key are handled
+    bool                    b_redraw;        ///< Something changed since the last draw
+    ws2812b_draw_paint_t *  p_paint;         ///< Paint of each object on the last draw, NULL to draw everything
+    ws2812b_span_t          damage;          ///< LEDs changed by the last draw
+    bool                    b_damage_all;    ///< The next draw must draw every LED
+} ws2812b_draw_ctx_t;
+
+
+void ws2812b_draw_ctx_init(ws2812b_draw_ctx_t * const p_ctx);
+void ws2812b_draw_ctx_setup(ws2812b_draw_ctx_t * const p_ctx,
+                            ws2812b_draw_objects_store_t * const p_objects_store,
+                            ws2812b_t * const p_instance);
+
+void ws2812b_draw_ctx_draw(ws2812b_draw_ctx_t * const p_ctx, int32_t tick_ms);
+int32_t ws2812b_draw_ctx_draw_at(ws2812b_draw_ctx_t * const p_ctx, int32_t const now_ms);
+void ws2812b_draw_ctx_render(ws2812b_draw_ctx_t const * const p_ctx,
+                             ws2812b_t * const p_instance);
+
+void ws2812b_draw_ctx_clear_objects(ws2812b_draw_ctx_t * const p_ctx);
+
+void ws2812b_draw_ctx_set_mode(ws2812b_draw_ctx_t * const p_ctx, ws2812b_draw_mode_t const mode);
+bool ws2812b_draw_ctx_set_events(ws2812b_draw_ctx_t * const p_ctx,
+                                 ws2812b_draw_event_t * const p_events,
+                                 size_t const events_count);
+bool ws2812b_draw_ctx_set_damage(ws2812b_draw_ctx_t * const p_ctx,
+                                 ws2812b_draw_paint_t * const p_paint,
+                                 size_t const paint_count);
+bool ws2812b_draw_ctx_get_damage(ws2812b_draw_ctx_t const * const p_ctx,
+                                 ws2812b_span_t * const p_span);
+
+void ws2812b_draw_ctx_set_action(ws2812b_draw_ctx_t * const p_ctx, size_t const element, ws2812b_draw_action_t action);
+void ws2812b_draw_ctx_set_direction(ws2812b_draw_ctx_t * const p_ctx, size_t const element, ws2812b_direction_t direction);
+void ws2812b_draw_ctx_set_blink_state(ws2812b_draw_ctx_t * const p_ctx, size_t const element, ws2812b_blink_state_t const state);
+void ws2812b_draw_ctx_set_blink_rate(ws2812b_draw_ctx_t * const p_ctx, size_t const element, int32_t const rate_ms);
+void ws2812b_draw_ctx_set_duration(ws2812b_draw_ctx_t * const p_ctx, size_t const element, int32_t const duration_ms);
+void ws2812b_draw_ctx_set_length(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const length);
+void ws2812b_draw_ctx_set_increment_rate(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const rate_ms);
+void ws2812b_draw_ctx_set_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const position);
+void ws2812b_draw_ctx_set_color(ws2812b_draw_ctx_t * const p_ctx,
+                                size_t const element,
+                                uint8_t const red,
+                                uint8_t const green,
+                                uint8_t const blue);
+void ws2812b_draw_ctx_set_start_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const position);
+void ws2812b_draw_ctx_set_end_position(ws2812b_draw_ctx_t * const p_ctx, size_t const element, size_t const position);
+void ws2812b_draw_ctx_set_grow(ws2812b_draw_ctx_t * const p_ctx, size_t const element, bool const b_grow);
+void ws2812b_draw_ctx_set_reverse(ws2812b_draw_ctx_t * const p_ctx, size_t const element, bool const b_reverse);
+
+bool ws2812b_draw_ctx_get_hit(ws2812b_draw_ctx_t * const p_ctx, size_t const element);
+ws2812b_direction_t ws2812b_draw_ctx_get_direction(ws2812b_draw_ctx_t const * const p_ctx, size_t const element);
+bool ws2812b_draw_ctx_get_obj_overlap(ws2812b_draw_ctx_t const * const p_ctx,
+                                      size_t const element_1,
+                                      size_t const element_2);
+
+void ws2812b_draw_ctx_effect_transition_colors(ws2812b_draw_ctx_t * const p_ctx,
+                                               size_t const element,
+                                               uint32_t const update_rate_ms,
+                                               uint32_t const step);
+
+
 void ws2812b_draw_setup(ws2812b_draw_objects_store_t * const p_objects_store,
                         ws2812b_t * const p_instance);
 
 void ws2812b_draw(int32_t tick_ms);
+int32_t ws2812b_draw_at(int32_t const now_ms);
 
 void ws2812b_draw_clear_objects(void);
 
+void ws2812b_draw_set_mode(ws2812b_draw_mode_t const mode);
+bool ws2812b_draw_set_events(ws2812b_draw_event_t * const p_events, size_t const events_count);
+bool ws2812b_draw_set_damage(ws2812b_draw_paint_t * const p_paint, size_t const paint_count);
+bool ws2812b_draw_get_damage(ws2812b_span_t * const p_span);
+
 void ws2812b_draw_set_action(size_t const element, ws2812b_draw_action_t action);
 void ws2812b_draw_set_direction(size_t const element, ws2812b_direction_t direction);
 void ws2812b_draw_set_blink_state(size_t const element, ws2812b_blink_state_t const state);
@@ -44,5 +163,7 @@ void ws2812b_draw_effect_transition_colors(size_t const element,
                                            uint32_t const update_rate_ms,
                                            uint32_t const step);
 
+ws2812b_draw_ctx_t * ws2812b_draw_get_default_ctx(void);
+
 
 #endif /* WS2812B_DRAW_H_ */
@@ -41,6 +41,12 @@ typedef enum
     DRAW_ACTION_BLINK_BLACK        ///< Object blink OFF state is black
 } ws2812b_draw_action_t;
 
+typedef enum
+{
+    DRAW_MODE_BUFFER, ///< Objects drawn into the storage buffer, app updates the stream
+    DRAW_MODE_STREAM, ///< Objects encoded once and drawn straight into the stream buffer
+} ws2812b_draw_mode_t;
+
 typedef enum
 {
     BLINK_STATE_ON,   ///< Blink state - LED ON
@@ -72,11 +78,50 @@ typedef struct
 } ws2812b_draw_object_t;
 
 
+/// Hot object fields as one dense array per field (struct of arrays)
+///
+/// Every array holds object_count entries.  The enums are kept as one byte
+/// each and the color as 0x00RRGGBB.  It mirrors the objects, the draw
+/// passes read it instead of the wide ws2812b_draw_object_t and the draw
+/// module keeps both up to date.  WS2812B_DRAW_SOA_DEFINE creates one.
+typedef struct
+{
+  uint8_t * p_action;            ///< ws2812b_draw_action_t of each object
+  uint8_t * p_blink_state;       ///< ws2812b_blink_state_t of each object
+  uint8_t * p_direction;         ///< ws2812b_direction_t of each object
+  int32_t * p_blink_rate_ms;     ///< Blink rate of each object
+  int32_t * p_duration_ms;       ///< Time each object stops being drawn
+  size_t *  p_increment_rate_ms; ///< Increment rate of each object
+  size_t *  p_position;          ///< Position of each object
+  size_t *  p_length;            ///< Length of each object
+  uint32_t * p_color;            ///< Color of each object, 0x00RRGGBB
+} ws2812b_draw_soa_t;
+
+/// Define the arrays of a ws2812b_draw_soa_t called name for count objects
+#define WS2812B_DRAW_SOA_DEFINE(name, count)                        \
+  static uint8_t  name##_action[(count)];                           \
+  static uint8_t  name##_blink_state[(count)];                      \
+  static uint8_t  name##_direction[(count)];                        \
+  static int32_t  name##_blink_rate_ms[(count)];                    \
+  static int32_t  name##_duration_ms[(count)];                      \
+  static size_t   name##_increment_rate_ms[(count)];                \
+  static size_t   name##_position[(count)];                         \
+  static size_t   name##_length[(count)];                           \
+  static uint32_t name##_color[(count)];                            \
+  static ws2812b_draw_soa_t name =                                  \
+  {                                                                 \
+    name##_action, name##_blink_state, name##_direction,            \
+    name##_blink_rate_ms, name##_duration_ms,                       \
+    name##_increment_rate_ms, name##_position, name##_length,       \
+    name##_color                                                    \
+  }
+
 /// Passed to the ws2812b_draw module for drawing
 typedef struct
 {
   ws2812b_draw_object_t * p_objects; ///< Pointer to array of objects to draw
   size_t object_count;               ///< The number of objects
+  ws2812b_draw_soa_t * p_soa;        ///< Optional dense copy of the hot fields, NULL if not used
 } ws2812b_draw_objects_store_t;
 
 #endif /* WS2812B_DRAW_COMMON_H_ */
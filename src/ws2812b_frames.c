@@ -0,0 +1,213 @@
+/// ws2812b_frames
+///
+/// This module rotates 2 or 3 stream buffers between the app and the SPI/DMA
+/// so the next frame can be encoded while the current one is sent
+///
+/// App side:      acquire -> ws2812b_update_stream... -> publish
+/// Transmit side: take -> spi_write -> (write complete) -> release
+///
+/// Acquire points ws2812b_t::p_stream at a buffer nobody else is using and
+/// brings it up to date with the last published frame, so the usual
+/// dirty-only encode still produces a complete frame.  Take always hands
+/// out the newest published frame, older unsent frames are dropped, so the
+/// transmitter never sends a partially encoded (torn) frame.
+
+#include "ws2812b_frames.h"
+
+#include <string.h>
+
+
+/// No buffer selected
+#define WS2812B_FRAMES_NONE ((size_t)-1)
+
+
+/// Initialize the stream buffer rotation
+///
+/// @param p_frames         The frames structure to initialize
+/// @param p_instance       The initialized strip the frames are for, each
+///                         buffer must be ws2812b_t::stream_sz bytes, not
+///                         an in place strip
+/// @param p_frame_buffers  Array of frame_count stream buffers
+/// @param frame_count      2 or 3 (WS2812B_FRAMES_MAX) buffers
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_frames_init(ws2812b_frames_t * const p_frames,
+                         ws2812b_t * const p_instance,
+                         uint8_t * const p_frame_buffers[],
+                         size_t const frame_count)
+{
+    bool b_result = false;
+
+    if( (NULL != p_frames) &&
+        (NULL != p_frame_buffers) &&
+        (0u < ws2812b_data_stream_bytes_per_led(p_instance)) &&
+        (NULL != p_instance->p_stream) &&
+        !p_instance->b_in_place &&
+        (2u <= frame_count) &&
+        (WS2812B_FRAMES_MAX >= frame_count) )
+    {
+        b_result = true;
+
+        for(size_t idx = 0; idx < frame_count; idx++)
+        {
+            p_frames->p_frames[idx] = p_frame_buffers[idx];
+            p_frames->state[idx] = WS2812B_FRAME_FREE;
+            b_result = b_result && (NULL != p_frame_buffers[idx]);
+        }
+
+        p_frames->p_instance = b_result ? p_instance : NULL;
+        p_frames->frame_count = frame_count;
+        p_frames->encoding = WS2812B_FRAMES_NONE;
+        p_frames->sending = WS2812B_FRAMES_NONE;
+        p_frames->latest = WS2812B_FRAMES_NONE;
+    }
+
+    return b_result;
+}
+
+/// Get a stream buffer to encode the next frame into (app side)
+///
+/// On success ws2812b_t::p_stream points at the acquired buffer, holding
+/// the last published frame.  Run the ws2812b_update_stream... function
+/// and then ws2812b_frames_publish.  Acquiring again before publishing
+/// keeps the same buffer.
+///
+/// @param p_frames The frames structure
+///
+/// @return TRUE if a buffer was acquired, FALSE if all are busy
+bool ws2812b_frames_acquire(ws2812b_frames_t * const p_frames)
+{
+    bool b_result = false;
+
+    if((NULL != p_frames) && (NULL != p_frames->p_instance))
+    {
+        size_t pick = p_frames->encoding;
+
+        WS2812B_FRAMES_LOCK();
+
+        // Prefer a free buffer, otherwise re-use the unsent frame
+        for(size_t idx = 0; (WS2812B_FRAMES_NONE == pick) && (idx < p_frames->frame_count); idx++)
+        {
+            if(WS2812B_FRAME_FREE == p_frames->state[idx])
+            {
+                pick = idx;
+            }
+        }
+
+        for(size_t idx = 0; (WS2812B_FRAMES_NONE == pick) && (idx < p_frames->frame_count); idx++)
+        {
+            if(WS2812B_FRAME_READY == p_frames->state[idx])
+            {
+                pick = idx;
+            }
+        }
+
+        if(WS2812B_FRAMES_NONE != pick)
+        {
+            p_frames->state[pick] = WS2812B_FRAME_ENCODING;
+        }
+
+        WS2812B_FRAMES_UNLOCK();
+
+        if((WS2812B_FRAMES_NONE != pick) && (pick != p_frames->encoding))
+        {
+            ws2812b_t * const p_instance = p_frames->p_instance;
+
+            if(WS2812B_FRAMES_NONE == p_frames->latest)
+            {
+                // Nothing published yet, encode everything
+                ws2812b_data_mark_dirty_all(p_instance);
+            }
+            else if(pick != p_frames->latest)
+            {
+                // Only the changes since the latest frame are encoded
+                memcpy(p_frames->p_frames[pick],
+                       p_frames->p_frames[p_frames->latest],
+                       p_instance->stream_sz);
+            }
+
+            p_instance->p_stream = p_frames->p_frames[pick];
+            p_frames->encoding = pick;
+        }
+
+        b_result = (WS2812B_FRAMES_NONE != pick);
+    }
+
+    return b_result;
+}
+
+/// Hand the encoded frame over to be sent (app side)
+///
+/// Any older frame that was never taken is dropped.
+///
+/// @param p_frames The frames structure
+void ws2812b_frames_publish(ws2812b_frames_t * const p_frames)
+{
+    if((NULL != p_frames) && (WS2812B_FRAMES_NONE != p_frames->encoding))
+    {
+        WS2812B_FRAMES_LOCK();
+
+        for(size_t idx = 0; idx < p_frames->frame_count; idx++)
+        {
+            if(WS2812B_FRAME_READY == p_frames->state[idx])
+            {
+                p_frames->state[idx] = WS2812B_FRAME_FREE;
+            }
+        }
+
+        p_frames->state[p_frames->encoding] = WS2812B_FRAME_READY;
+        p_frames->latest = p_frames->encoding;
+        p_frames->encoding = WS2812B_FRAMES_NONE;
+
+        WS2812B_FRAMES_UNLOCK();
+    }
+}
+
+/// Take the newest published frame to send (transmit side)
+///
+/// Send ws2812b_t::stream_sz bytes from the returned buffer and call
+/// ws2812b_frames_release once the write completes.
+///
+/// @param p_frames The frames structure
+///
+/// @return The stream buffer to send, NULL if there is no new frame or
+///         the previous frame was not released
+uint8_t * ws2812b_frames_take(ws2812b_frames_t * const p_frames)
+{
+    uint8_t * p_stream = NULL;
+
+    if((NULL != p_frames) && (WS2812B_FRAMES_NONE == p_frames->sending))
+    {
+        WS2812B_FRAMES_LOCK();
+
+        for(size_t idx = 0; idx < p_frames->frame_count; idx++)
+        {
+            if(WS2812B_FRAME_READY == p_frames->state[idx])
+            {
+                p_frames->state[idx] = WS2812B_FRAME_SENDING;
+                p_frames->sending = idx;
+                p_stream = p_frames->p_frames[idx];
+            }
+        }
+
+        WS2812B_FRAMES_UNLOCK();
+    }
+
+    return p_stream;
+}
+
+/// Give the sent frame back once the write completes (transmit side)
+///
+/// @param p_frames The frames structure
+void ws2812b_frames_release(ws2812b_frames_t * const p_frames)
+{
+    if((NULL != p_frames) && (WS2812B_FRAMES_NONE != p_frames->sending))
+    {
+        WS2812B_FRAMES_LOCK();
+
+        p_frames->state[p_frames->sending] = WS2812B_FRAME_FREE;
+        p_frames->sending = WS2812B_FRAMES_NONE;
+
+        WS2812B_FRAMES_UNLOCK();
+    }
+}
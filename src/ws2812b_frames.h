@@ -0,0 +1,59 @@
+/// ws2812b_frames
+///
+/// This module rotates 2 or 3 stream buffers between the app and the SPI/DMA
+/// so the next frame can be encoded while the current one is sent
+
+#ifndef WS2812B_FRAMES_H_
+#define WS2812B_FRAMES_H_
+
+#include "ws2812b_data.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+
+/// Most stream buffers a ws2812b_frames_t can rotate
+#define WS2812B_FRAMES_MAX 3u
+
+/// Guard the frame states when the transmit side runs from an interrupt
+/// Define these to disable/restore interrupts (or take a lock) for the platform
+#ifndef WS2812B_FRAMES_LOCK
+#define WS2812B_FRAMES_LOCK()
+#endif
+#ifndef WS2812B_FRAMES_UNLOCK
+#define WS2812B_FRAMES_UNLOCK()
+#endif
+
+typedef enum
+{
+  WS2812B_FRAME_FREE,      ///< Not in use, can be encoded into
+  WS2812B_FRAME_ENCODING,  ///< Owned by the app, being encoded into
+  WS2812B_FRAME_READY,     ///< Complete frame waiting to be sent
+  WS2812B_FRAME_SENDING,   ///< Owned by the SPI/DMA
+}ws2812b_frame_state_t;
+
+/// This struct holds the stream buffers rotated for a ws2812b strip
+typedef struct
+{
+    ws2812b_t *                    p_instance;                    ///< Strip the frames are encoded for
+    uint8_t *                      p_frames[WS2812B_FRAMES_MAX];  ///< Stream buffers, each ws2812b_t::stream_sz bytes
+    volatile ws2812b_frame_state_t state[WS2812B_FRAMES_MAX];     ///< State of each stream buffer
+    size_t                         frame_count;                   ///< The number of stream buffers in use
+    size_t                         encoding;                      ///< Buffer acquired by the app
+    size_t                         sending;                       ///< Buffer taken by the SPI/DMA
+    size_t                         latest;                        ///< Most recently published buffer
+}
+ws2812b_frames_t;
+
+
+bool ws2812b_frames_init(ws2812b_frames_t * const p_frames,
+                         ws2812b_t * const p_instance,
+                         uint8_t * const p_frame_buffers[],
+                         size_t const frame_count);
+bool ws2812b_frames_acquire(ws2812b_frames_t * const p_frames);
+void ws2812b_frames_publish(ws2812b_frames_t * const p_frames);
+uint8_t * ws2812b_frames_take(ws2812b_frames_t * const p_frames);
+void ws2812b_frames_release(ws2812b_frames_t * const p_frames);
+
+#endif /* WS2812B_FRAMES_H_ */
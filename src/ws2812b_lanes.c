@@ -0,0 +1,322 @@
+/// ws2812b_lanes
+///
+/// This module encodes up to 16 strips into one bit sliced stream
+///
+/// With one strip per data pin of a parallel output, stream word n carries
+/// stream bit n of every strip.  Each lane is encoded as usual with
+/// ws2812b_data_encode, a block at a time, into rows side by side.  The rows
+/// are then bit transposed, every stream byte of the 16 rows into 8 words (a
+/// vector kernel from ws2812b_data_simd where available, 8x8 bit matrix
+/// transposes otherwise).  So every lane carries exactly the stream it
+/// would on its own, color correction, palette and run encoding included.
+
+#include "ws2812b_lanes.h"
+#include "ws2812b_data_simd.h"
+
+#include <string.h>
+
+
+static void ws2812b_lanes_encode(ws2812b_lanes_t const * const p_lanes,
+                                 size_t const start,
+                                 size_t const end);
+static void ws2812b_lanes_transpose(uint8_t * const p_dst,
+                                    size_t const word_sz,
+                                    uint8_t const * const p_rows,
+                                    size_t const row_stride,
+                                    size_t const size);
+
+
+/// Initialize strips encoded side by side
+///
+/// The strips must be initialized (their own stream is not needed) for
+/// formats with the same stream bytes per LED, as the lanes share the bit
+/// clock.  16 bit storage, in place and UART strips are not supported.
+/// The first ws2812b_lanes_update encodes every LED.
+///
+/// @param p_lanes         The structure to initialize
+/// @param p_strips        The strips, p_strips[k] is sent on bit k
+/// @param lane_count      The number of strips, 1 to WS2812B_LANES_MAX
+/// @param p_stream        The stream buffer
+/// @param stream_sz       The size of p_stream, see WS2812B_LANES_STREAM_SZ
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_lanes_init(ws2812b_lanes_t * const p_lanes,
+                        ws2812b_t * const * const p_strips,
+                        size_t const lane_count,
+                        uint8_t * const p_stream,
+                        size_t const stream_sz)
+{
+    bool b_result = false;
+
+    if((NULL != p_lanes) &&
+       (NULL != p_strips) &&
+       (NULL != p_stream) &&
+       (0u < lane_count) &&
+       (WS2812B_LANES_MAX >= lane_count))
+    {
+        size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_strips[0]);
+        size_t led_count = 0u;
+
+        b_result = (0u < bytes_per_led) && (WS2812B_LANES_BLOCK_BYTES >= bytes_per_led);
+        p_lanes->lane_count = 0u;
+
+        for(size_t lane = 0; b_result && (lane < lane_count); lane++)
+        {
+            ws2812b_t const * const p_strip = p_strips[lane];
+
+            b_result = (bytes_per_led == ws2812b_data_stream_bytes_per_led(p_strip)) &&
+                       (WS2812B_INIT_UART != p_strip->init_state) &&
+                       (NULL == p_strip->p_buffer16) &&
+                       !p_strip->b_in_place;
+
+            if(b_result && (led_count < p_strip->led_count))
+            {
+                led_count = p_strip->led_count;
+            }
+        }
+
+        // Verify not beyond bounds
+        if(b_result)
+        {
+            size_t const stream_len = WS2812B_LANES_STREAM_SZ(led_count, lane_count, bytes_per_led);
+
+            b_result = (stream_len <= stream_sz);
+
+            if(b_result)
+            {
+                for(size_t lane = 0; lane < lane_count; lane++)
+                {
+                    p_lanes->p_lanes[lane] = p_strips[lane];
+                    ws2812b_data_mark_dirty_all(p_strips[lane]);
+                }
+
+                p_lanes->bytes_per_led = bytes_per_led;
+                p_lanes->p_stream = p_stream;
+                p_lanes->stream_sz = stream_sz;
+                p_lanes->stream_len = stream_len;
+                p_lanes->word_sz = WS2812B_LANES_WORD_SIZE(lane_count);
+                p_lanes->led_count = led_count;
+                p_lanes->lane_count = lane_count;
+
+                // Padding after the shorter lanes is never written again
+                memset(p_stream, 0, stream_len);
+            }
+        }
+    }
+
+    return b_result;
+}
+
+/// Encode the LEDs changed on any lane into the stream
+///
+/// Takes the dirty spans of every lane, so the strips must not also be
+/// streamed on their own.
+///
+/// @param p_lanes         The lanes
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_lanes_update(ws2812b_lanes_t * const p_lanes)
+{
+    bool b_result = false;
+
+    if((NULL != p_lanes) && (0u < p_lanes->lane_count))
+    {
+        ws2812b_span_t spans[WS2812B_DIRTY_SPAN_MAX];
+        size_t span_count = 0u;
+
+        for(size_t lane = 0; lane < p_lanes->lane_count; lane++)
+        {
+            ws2812b_t * const p_strip = p_lanes->p_lanes[lane];
+
+            for(size_t idx = 0; idx < p_strip->dirty_count; idx++)
+            {
+                ws2812b_data_span_add(spans, &span_count,
+                                      p_strip->dirty[idx].start, p_strip->dirty[idx].end);
+            }
+
+            p_strip->dirty_count = 0u;
+        }
+
+        for(size_t idx = 0; idx < span_count; idx++)
+        {
+            ws2812b_lanes_encode(p_lanes, spans[idx].start, spans[idx].end);
+        }
+
+        b_result = true;
+    }
+
+    return b_result;
+}
+
+/// Copy one lane out of the stream as a single strip stream
+///
+/// The result matches ws2812b_data_encode of that strip, which is how the
+/// bit slicing can be checked on a host.
+///
+/// @param p_lanes         The lanes
+/// @param lane            The lane to copy, 0 based
+/// @param p_dst           Where the single strip stream is written
+/// @param dst_sz          The size of p_dst, at least
+///                        ws2812b_data_stream_bytes_per_led per LED of the lane
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_lanes_extract(ws2812b_lanes_t const * const p_lanes,
+                           size_t const lane,
+                           uint8_t * const p_dst,
+                           size_t const dst_sz)
+{
+    bool b_result = false;
+
+    if((NULL != p_lanes) &&
+       (NULL != p_dst) &&
+       (lane < p_lanes->lane_count))
+    {
+        size_t const bytes = p_lanes->p_lanes[lane]->led_count * p_lanes->bytes_per_led;
+        uint8_t const * p_word = p_lanes->p_stream;
+
+        if(bytes <= dst_sz)
+        {
+            for(size_t idx = 0; idx < bytes; idx++)
+            {
+                uint32_t value = 0u;
+
+                for(size_t bit = 0; bit < 8u; bit++)
+                {
+                    uint16_t word = *p_word;
+
+                    if(1u < p_lanes->word_sz)
+                    {
+                        memcpy(&word, p_word, sizeof(word));
+                    }
+
+                    value = (value << 1) | ((word >> lane) & 1u);
+                    p_word += p_lanes->word_sz;
+                }
+
+                p_dst[idx] = (uint8_t)value;
+            }
+
+            b_result = true;
+        }
+    }
+
+    return b_result;
+}
+
+
+/// Encode LEDs of every lane into the stream
+///
+/// @param p_lanes         The lanes
+/// @param start           First LED index
+/// @param end             One past the last LED index
+static void ws2812b_lanes_encode(ws2812b_lanes_t const * const p_lanes,
+                                 size_t const start,
+                                 size_t const end)
+{
+    uint8_t rows[WS2812B_LANES_MAX][WS2812B_LANES_BLOCK_BYTES];
+    size_t const bytes_per_led = p_lanes->bytes_per_led;
+    size_t const block_leds = WS2812B_LANES_BLOCK_BYTES / bytes_per_led;
+    size_t const word_sz = p_lanes->word_sz;
+
+    // Lanes not in use send nothing
+    for(size_t lane = p_lanes->lane_count; lane < WS2812B_LANES_MAX; lane++)
+    {
+        memset(rows[lane], 0, sizeof(rows[lane]));
+    }
+
+    for(size_t led = start; led < end; led += block_leds)
+    {
+        size_t const count = ((end - led) < block_leds) ? (end - led) : block_leds;
+
+        for(size_t lane = 0; lane < p_lanes->lane_count; lane++)
+        {
+            ws2812b_t const * const p_strip = p_lanes->p_lanes[lane];
+            size_t const lane_leds = (led >= p_strip->led_count) ? 0u :
+                (((p_strip->led_count - led) < count) ? (p_strip->led_count - led) : count);
+
+            if(0u < lane_leds)
+            {
+                ws2812b_data_encode(p_strip, rows[lane], led + 1u, lane_leds);
+            }
+
+            // Past the end of a shorter lane
+            memset(&rows[lane][lane_leds * bytes_per_led], 0, (count - lane_leds) * bytes_per_led);
+        }
+
+        ws2812b_lanes_transpose(&p_lanes->p_stream[led * bytes_per_led * 8u * word_sz],
+                                word_sz,
+                                &rows[0][0],
+                                WS2812B_LANES_BLOCK_BYTES,
+                                count * bytes_per_led);
+    }
+}
+
+/// Bit transpose lane rows into stream words
+///
+/// Byte i of the rows becomes 8 words, the first from bit 7, bit k of a
+/// word from row k.  Whatever the vector kernel leaves is done as one or two
+/// 8x8 bit matrix transposes in a 64 bit word (Hacker's Delight, transpose8).
+///
+/// @param p_dst           Where to write the words
+/// @param word_sz         Bytes per word, 1 keeps rows 0 to 7
+/// @param p_rows          WS2812B_LANES_MAX rows of lane stream bytes
+/// @param row_stride      Bytes from one row to the next
+/// @param size            The number of bytes of each row to transpose
+static void ws2812b_lanes_transpose(uint8_t * const p_dst,
+                                    size_t const word_sz,
+                                    uint8_t const * const p_rows,
+                                    size_t const row_stride,
+                                    size_t const size)
+{
+    size_t done = 0u;
+    ws2812b_simd_kernels_t const * const p_simd = ws2812b_simd_kernels();
+
+    if(NULL != p_simd->transpose)
+    {
+        done = p_simd->transpose(p_dst, word_sz, p_rows, row_stride, size);
+    }
+
+    for(size_t idx = done; idx < size; idx++)
+    {
+        uint16_t words[8] = {0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u};
+
+        for(size_t half = 0; half < word_sz; half++)
+        {
+            uint64_t x = 0u;
+            uint64_t t;
+
+            // Byte k of x is row k of this half
+            for(size_t row = 0; row < 8u; row++)
+            {
+                x |= (uint64_t)p_rows[(((half * 8u) + row) * row_stride) + idx] << (row * 8u);
+            }
+
+            t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+            x = x ^ t ^ (t << 7);
+            t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+            x = x ^ t ^ (t << 14);
+            t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+            x = x ^ t ^ (t << 28);
+
+            // Now byte b of x is bit b of every row
+            for(size_t bit = 0; bit < 8u; bit++)
+            {
+                words[bit] |= (uint16_t)(((x >> ((7u - bit) * 8u)) & 0xFFu) << (half * 8u));
+            }
+        }
+
+        for(size_t bit = 0; bit < 8u; bit++)
+        {
+            uint8_t * const p_out = &p_dst[((idx * 8u) + bit) * word_sz];
+
+            if(1u == word_sz)
+            {
+                *p_out = (uint8_t)words[bit];
+            }
+            else
+            {
+                memcpy(p_out, &words[bit], sizeof(words[bit]));
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/// ws2812b_lanes
+///
+/// This module encodes up to 16 strips into one bit sliced stream, for
+/// peripherals that drive a parallel port (or 8/16 bit I2S) one word per
+/// symbol bit with every strip on its own data pin
+
+#ifndef WS2812B_LANES_H_
+#define WS2812B_LANES_H_
+
+#include "ws2812b_data.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+
+/// Most strips in one stream, one per bit of a 16 bit word
+#define WS2812B_LANES_MAX 16u
+
+/// Bytes per word of the stream, 8 lanes fit a byte
+#define WS2812B_LANES_WORD_SIZE(lane_count) (((lane_count) > 8u) ? 2u : 1u)
+
+/// Stream size for lane_count lanes of up to led_count LEDs of
+/// bytes_per_led stream bytes each (e.g. WS2812_BYTES_PER_LED_2P5MHZ)
+#define WS2812B_LANES_STREAM_SZ(led_count, lane_count, bytes_per_led) \
+    ((led_count) * (bytes_per_led) * 8u * WS2812B_LANES_WORD_SIZE(lane_count))
+
+/// Stream bytes of each lane encoded per step, ws2812b_lanes_update keeps
+/// WS2812B_LANES_MAX times this on the stack
+#ifndef WS2812B_LANES_BLOCK_BYTES
+#define WS2812B_LANES_BLOCK_BYTES 144u
+#endif
+
+/// This struct holds strips encoded side by side
+///
+/// Every stream word is one stream bit of all lanes, bit k of the word for
+/// lane k, in the CPU byte order for 16 bit words.  Lanes shorter than the
+/// longest are held low once their LEDs are sent.
+typedef struct
+{
+    ws2812b_t *               p_lanes[WS2812B_LANES_MAX]; ///< Strip of every lane
+    size_t                    lane_count;     ///< The number of lanes in use
+    size_t                    bytes_per_led;  ///< Stream bytes per LED of every lane
+    uint8_t *                 p_stream;       ///< The bit sliced stream
+    size_t                    stream_sz;      ///< The size of p_stream
+    size_t                    stream_len;     ///< Stream bytes to send, from the longest lane
+    size_t                    word_sz;        ///< Bytes per stream word, 1 or 2
+    size_t                    led_count;      ///< LEDs of the longest lane
+}
+ws2812b_lanes_t;
+
+
+bool ws2812b_lanes_init(ws2812b_lanes_t * const p_lanes,
+                        ws2812b_t * const * const p_strips,
+                        size_t const lane_count,
+                        uint8_t * const p_stream,
+                        size_t const stream_sz);
+bool ws2812b_lanes_update(ws2812b_lanes_t * const p_lanes);
+bool ws2812b_lanes_extract(ws2812b_lanes_t const * const p_lanes,
+                           size_t const lane,
+                           uint8_t * const p_dst,
+                           size_t const dst_sz);
+
+#endif /* WS2812B_LANES_H_ */
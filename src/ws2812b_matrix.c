@@ -0,0 +1,309 @@
+/// ws2812b_matrix
+///
+/// This module maps the pixels of a 2D image onto a strip wired as a matrix
+/// of one or more panels
+///
+/// ws2812b_matrix_init works out the LED of every image pixel once, for the
+/// panel wiring (progressive or serpentine), the panel tiling and the image
+/// rotation, and keeps it in an app supplied map table.  It also splits the
+/// image rows into runs of pixels on consecutive LEDs.  When the runs are
+/// long (e.g. serpentine rows) ws2812b_matrix_blit copies each run with
+/// ws2812b_data_blit, otherwise (e.g. a rotated matrix, where every pixel
+/// of a row is on a different wired row) it writes the pixels through the
+/// map table with ws2812b_data_scatter.
+
+#include "ws2812b_matrix.h"
+
+
+static void ws2812b_matrix_place(ws2812b_matrix_layout_t const * const p_layout,
+                                 size_t const led,
+                                 size_t * const p_x,
+                                 size_t * const p_y);
+static void ws2812b_matrix_find_runs(ws2812b_matrix_t * const p_matrix,
+                                     ws2812b_matrix_run_t * const p_runs,
+                                     size_t const runs_sz);
+
+
+/// Initialize a matrix and build its map table
+///
+/// @param p_matrix        The matrix structure to initialize
+/// @param p_instance      The initialized strip the matrix is on
+/// @param p_layout        How the matrix is wired, only read during init
+/// @param p_map           Map table, WS2812B_MATRIX_MAP_SZ(width, height) entries
+/// @param map_sz          The number of entries in p_map
+/// @param p_runs          Run table, NULL to always use the map table.  A
+///                        serpentine or progressive matrix needs one run per
+///                        wired row.
+/// @param runs_sz         The number of entries in p_runs
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_matrix_init(ws2812b_matrix_t * const p_matrix,
+                         ws2812b_t * const p_instance,
+                         ws2812b_matrix_layout_t const * const p_layout,
+                         size_t * const p_map,
+                         size_t const map_sz,
+                         ws2812b_matrix_run_t * const p_runs,
+                         size_t const runs_sz)
+{
+    bool b_result = false;
+
+    if((NULL != p_matrix) &&
+       (NULL != p_instance) &&
+       (NULL != p_layout) &&
+       (NULL != p_map) &&
+       (0u < p_layout->led_num_start) &&
+       (WS2812B_MATRIX_ROTATE_270 >= p_layout->rotation))
+    {
+        size_t const wired_width = p_layout->panel_width * p_layout->panels_x;
+        size_t const wired_height = p_layout->panel_height * p_layout->panels_y;
+        size_t const count = wired_width * wired_height;
+        size_t const led_idx = (p_layout->led_num_start - 1u);
+        bool const b_turned = (WS2812B_MATRIX_ROTATE_90 == p_layout->rotation) ||
+                              (WS2812B_MATRIX_ROTATE_270 == p_layout->rotation);
+
+        p_matrix->p_instance = NULL;
+
+        // Verify not beyond bounds
+        if((0u < count) &&
+           (count <= map_sz) &&
+           (led_idx <= p_instance->led_count) &&
+           (count <= (p_instance->led_count - led_idx)))
+        {
+            p_matrix->width = b_turned ? wired_height : wired_width;
+            p_matrix->height = b_turned ? wired_width : wired_height;
+            p_matrix->p_map = p_map;
+
+            for(size_t led = 0; led < count; led++)
+            {
+                size_t x;
+                size_t y;
+
+                ws2812b_matrix_place(p_layout, led, &x, &y);
+                p_map[(y * p_matrix->width) + x] = led_idx + led;
+            }
+
+            ws2812b_matrix_find_runs(p_matrix, p_runs, runs_sz);
+            p_matrix->p_instance = p_instance;
+            b_result = true;
+        }
+    }
+
+    return b_result;
+}
+
+/// Get the strip LED of an image pixel
+///
+/// @param p_matrix        The matrix
+/// @param x               Image column, 0 is the left
+/// @param y               Image row, 0 is the top
+///
+/// @return The LED number (1 based), 0 if the pixel is not on the matrix
+size_t ws2812b_matrix_led(ws2812b_matrix_t const * const p_matrix,
+                          size_t const x,
+                          size_t const y)
+{
+    size_t led_num = 0u;
+
+    if((NULL != p_matrix) &&
+       (NULL != p_matrix->p_instance) &&
+       (x < p_matrix->width) &&
+       (y < p_matrix->height))
+    {
+        led_num = p_matrix->p_map[(y * p_matrix->width) + x] + 1u;
+    }
+
+    return led_num;
+}
+
+/// Set value for an image pixel of the matrix
+///
+/// @param p_matrix        The matrix
+/// @param x               Image column, 0 is the left
+/// @param y               Image row, 0 is the top
+/// @param red             The red value
+/// @param green           The green value
+/// @param blue            The blue value
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_matrix_set(ws2812b_matrix_t const * const p_matrix,
+                        size_t const x,
+                        size_t const y,
+                        uint8_t const red,
+                        uint8_t const green,
+                        uint8_t const blue)
+{
+    bool b_result = false;
+    size_t const led_num = ws2812b_matrix_led(p_matrix, x, y);
+
+    if(0u < led_num)
+    {
+        b_result = ws2812b_data_set(p_matrix->p_instance, led_num, red, green, blue);
+    }
+
+    return b_result;
+}
+
+/// Copy a whole image onto the matrix
+///
+/// @param p_matrix        The matrix
+/// @param p_image         The top left pixel, rows top to bottom
+/// @param format          Channel order and size of a pixel
+/// @param row_stride      Bytes from one image row to the next, 0 for packed rows
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_matrix_blit(ws2812b_matrix_t const * const p_matrix,
+                         uint8_t const * const p_image,
+                         ws2812b_pixel_format_t const format,
+                         size_t const row_stride)
+{
+    bool b_result = false;
+
+    if((NULL != p_matrix) &&
+       (NULL != p_matrix->p_instance) &&
+       (NULL != p_image))
+    {
+        size_t const pixel_sz = WS2812B_PIXEL_SIZE(format);
+        size_t const row_step = (0u == row_stride) ? (p_matrix->width * pixel_sz) : row_stride;
+
+        b_result = (p_matrix->width * pixel_sz) <= row_step;
+
+        for(size_t idx = 0; b_result && (idx < p_matrix->run_count); idx++)
+        {
+            ws2812b_matrix_run_t const * const p_run = &p_matrix->p_runs[idx];
+            size_t const y = p_run->pixel / p_matrix->width;
+            size_t const x = p_run->pixel % p_matrix->width;
+
+            b_result = ws2812b_data_blit(p_matrix->p_instance,
+                                         p_run->led + 1u,
+                                         p_run->count,
+                                         &p_image[(y * row_step) + (x * pixel_sz)],
+                                         format,
+                                         0u,
+                                         p_run->b_reverse);
+        }
+
+        // Without runs every row goes through the map table
+        for(size_t y = 0; b_result && (0u == p_matrix->run_count) && (y < p_matrix->height); y++)
+        {
+            b_result = ws2812b_data_scatter(p_matrix->p_instance,
+                                            &p_matrix->p_map[y * p_matrix->width],
+                                            p_matrix->width,
+                                            &p_image[y * row_step],
+                                            format,
+                                            0u);
+        }
+    }
+
+    return b_result;
+}
+
+
+/// Find the image pixel of a LED of the matrix
+///
+/// @param p_layout        How the matrix is wired
+/// @param led             LED along the matrix (0 based, from led_num_start)
+/// @param p_x             Set to the image column
+/// @param p_y             Set to the image row
+static void ws2812b_matrix_place(ws2812b_matrix_layout_t const * const p_layout,
+                                 size_t const led,
+                                 size_t * const p_x,
+                                 size_t * const p_y)
+{
+    size_t const wired_width = p_layout->panel_width * p_layout->panels_x;
+    size_t const wired_height = p_layout->panel_height * p_layout->panels_y;
+    size_t const panel_leds = p_layout->panel_width * p_layout->panel_height;
+    size_t const panel = led / panel_leds;
+    size_t const panel_row = panel / p_layout->panels_x;
+    size_t const row = (led % panel_leds) / p_layout->panel_width;
+    size_t panel_col = panel % p_layout->panels_x;
+    size_t col = (led % panel_leds) % p_layout->panel_width;
+
+    if((WS2812B_MATRIX_SERPENTINE == p_layout->panel_wiring) && (0u != (panel_row & 1u)))
+    {
+        panel_col = p_layout->panels_x - 1u - panel_col;
+    }
+
+    if((WS2812B_MATRIX_SERPENTINE == p_layout->wiring) && (0u != (row & 1u)))
+    {
+        col = p_layout->panel_width - 1u - col;
+    }
+
+    size_t const wired_x = (panel_col * p_layout->panel_width) + col;
+    size_t const wired_y = (panel_row * p_layout->panel_height) + row;
+
+    if(WS2812B_MATRIX_ROTATE_90 == p_layout->rotation)
+    {
+        // The image top left is the wired top right
+        *p_x = wired_y;
+        *p_y = wired_width - 1u - wired_x;
+    }
+    else if(WS2812B_MATRIX_ROTATE_180 == p_layout->rotation)
+    {
+        *p_x = wired_width - 1u - wired_x;
+        *p_y = wired_height - 1u - wired_y;
+    }
+    else if(WS2812B_MATRIX_ROTATE_270 == p_layout->rotation)
+    {
+        // The image top left is the wired bottom left
+        *p_x = wired_height - 1u - wired_y;
+        *p_y = wired_x;
+    }
+    else
+    {
+        *p_x = wired_x;
+        *p_y = wired_y;
+    }
+}
+
+/// Split the image rows into runs of pixels on consecutive LEDs
+///
+/// The runs are only used when they all fit and average at least
+/// WS2812B_MATRIX_RUN_AVG_MIN pixels, a blit call per pixel or two is
+/// slower than going through the map table.
+///
+/// @param p_matrix        The matrix, with its map table built
+/// @param p_runs          Run table, NULL for none
+/// @param runs_sz         The number of entries in p_runs
+static void ws2812b_matrix_find_runs(ws2812b_matrix_t * const p_matrix,
+                                     ws2812b_matrix_run_t * const p_runs,
+                                     size_t const runs_sz)
+{
+    size_t const width = p_matrix->width;
+    size_t count = 0u;
+    bool b_fits = (NULL != p_runs);
+
+    for(size_t y = 0; b_fits && (y < p_matrix->height); y++)
+    {
+        size_t const * const p_row = &p_matrix->p_map[y * width];
+        size_t x = 0u;
+
+        while(b_fits && (x < width))
+        {
+            size_t end = x + 1u;
+            bool const b_reverse = (end < width) && ((p_row[end] + 1u) == p_row[x]);
+
+            while((end < width) &&
+                  (p_row[end] == (b_reverse ? (p_row[end - 1u] - 1u) : (p_row[end - 1u] + 1u))))
+            {
+                end++;
+            }
+
+            b_fits = (count < runs_sz);
+
+            if(b_fits)
+            {
+                p_runs[count].pixel = (y * width) + x;
+                p_runs[count].led = b_reverse ? p_row[end - 1u] : p_row[x];
+                p_runs[count].count = end - x;
+                p_runs[count].b_reverse = b_reverse;
+                count++;
+            }
+
+            x = end;
+        }
+    }
+
+    p_matrix->p_runs = p_runs;
+    p_matrix->run_count =
+        (b_fits && ((count * WS2812B_MATRIX_RUN_AVG_MIN) <= (width * p_matrix->height))) ? count : 0u;
+}
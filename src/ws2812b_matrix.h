@@ -0,0 +1,100 @@
+/// ws2812b_matrix
+///
+/// This module maps the pixels of a 2D image onto a strip wired as a matrix
+/// of one or more panels, with the mapping worked out once at init
+
+#ifndef WS2812B_MATRIX_H_
+#define WS2812B_MATRIX_H_
+
+#include "ws2812b_data.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+
+/// Image pixels for a matrix of width x height LEDs, size of the map table
+#define WS2812B_MATRIX_MAP_SZ(width, height) ((width) * (height))
+
+/// Runs are blitted when they average at least this many pixels, shorter
+/// runs are written through the map table instead
+#define WS2812B_MATRIX_RUN_AVG_MIN 8u
+
+/// Order of the LEDs along a panel's rows
+typedef enum
+{
+  WS2812B_MATRIX_PROGRESSIVE,   ///< Every row runs left to right
+  WS2812B_MATRIX_SERPENTINE,    ///< Every other row runs back, right to left
+}ws2812b_matrix_wiring_t;
+
+/// Clockwise rotation of the image on the wired matrix
+typedef enum
+{
+  WS2812B_MATRIX_ROTATE_0,      ///< Image x along the wired rows
+  WS2812B_MATRIX_ROTATE_90,     ///< Image x down the wired columns
+  WS2812B_MATRIX_ROTATE_180,    ///< Upside down
+  WS2812B_MATRIX_ROTATE_270,    ///< Image x up the wired columns
+}ws2812b_matrix_rotation_t;
+
+/// This struct describes how a matrix is wired
+///
+/// Each panel is wired from its top left LED along its rows.  Panels are
+/// chained along the rows of panels, starting top left.
+typedef struct
+{
+    size_t                    led_num_start;  ///< Strip LED (1 based) of the first LED of the first panel
+    size_t                    panel_width;    ///< LEDs along a wired row of a panel
+    size_t                    panel_height;   ///< Wired rows of a panel
+    size_t                    panels_x;       ///< Panels along a row of panels
+    size_t                    panels_y;       ///< Rows of panels
+    ws2812b_matrix_wiring_t   wiring;         ///< LED order within a panel
+    ws2812b_matrix_wiring_t   panel_wiring;   ///< Panel order, serpentine when every other row of panels runs back
+    ws2812b_matrix_rotation_t rotation;       ///< Rotation of the image
+}
+ws2812b_matrix_layout_t;
+
+/// A row of image pixels that sits on consecutive LEDs
+typedef struct
+{
+    size_t pixel;                             ///< First image pixel (y * width + x)
+    size_t led;                               ///< Lowest LED index of the run (0 based)
+    size_t count;                             ///< Pixels in the run
+    bool   b_reverse;                         ///< The LEDs count down as the image x goes up
+}
+ws2812b_matrix_run_t;
+
+/// This struct holds a matrix on a strip
+typedef struct
+{
+    ws2812b_t *            p_instance;        ///< Strip the matrix is on
+    size_t                 width;             ///< Image width, after the rotation
+    size_t                 height;            ///< Image height, after the rotation
+    size_t *               p_map;             ///< LED index (0 based) of every image pixel, row by row
+    ws2812b_matrix_run_t * p_runs;            ///< Runs of the image rows, NULL for none
+    size_t                 run_count;         ///< Runs in use, 0 when the map table is used
+}
+ws2812b_matrix_t;
+
+
+bool ws2812b_matrix_init(ws2812b_matrix_t * const p_matrix,
+                         ws2812b_t * const p_instance,
+                         ws2812b_matrix_layout_t const * const p_layout,
+                         size_t * const p_map,
+                         size_t const map_sz,
+                         ws2812b_matrix_run_t * const p_runs,
+                         size_t const runs_sz);
+size_t ws2812b_matrix_led(ws2812b_matrix_t const * const p_matrix,
+                          size_t const x,
+                          size_t const y);
+bool ws2812b_matrix_set(ws2812b_matrix_t const * const p_matrix,
+                        size_t const x,
+                        size_t const y,
+                        uint8_t const red,
+                        uint8_t const green,
+                        uint8_t const blue);
+bool ws2812b_matrix_blit(ws2812b_matrix_t const * const p_matrix,
+                         uint8_t const * const p_image,
+                         ws2812b_pixel_format_t const format,
+                         size_t const row_stride);
+
+#endif /* WS2812B_MATRIX_H_ */
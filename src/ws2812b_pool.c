@@ -0,0 +1,287 @@
+/// ws2812b_pool
+///
+/// This module spreads stream encoding of long strips, or of many strips,
+/// across a fixed pool of worker threads (POSIX threads, host builds only)
+///
+/// A job is the dirty spans of a list of strips, the same work the
+/// ws2812b_update_stream... functions do.  Spans are cut into slices of at
+/// most slice_leds LEDs.  Slices always start on an LED boundary, which is
+/// a whole byte at every stream rate, so workers never share a stream byte.
+/// The calling thread works on the job too, so a pool of N threads keeps
+/// N + 1 cores busy.  A strip with a 16 bit buffer is dithered a slice at a
+/// time, right before the slice is encoded.
+
+#include "ws2812b_pool.h"
+
+
+static void * ws2812b_pool_worker(void * p_arg);
+static void ws2812b_pool_run(ws2812b_pool_t * const p_pool);
+
+/// Start a pool of encode workers
+///
+/// @param p_pool        The pool to start
+/// @param thread_count  Worker threads to start, 0 encodes on the caller only
+/// @param slice_leds    Most LEDs per slice, 0 uses WS2812B_POOL_SLICE_LEDS
+///
+/// @return TRUE on success, FALSE otherwise
+bool ws2812b_pool_init(ws2812b_pool_t * const p_pool,
+                       size_t const thread_count,
+                       size_t const slice_leds)
+{
+    bool b_result = false;
+
+    if((NULL != p_pool) && (WS2812B_POOL_THREADS_MAX >= thread_count))
+    {
+        p_pool->thread_count = 0u;
+        p_pool->slice_leds = (0u < slice_leds) ? slice_leds : WS2812B_POOL_SLICE_LEDS;
+        p_pool->pp_instances = NULL;
+        p_pool->instance_count = 0u;
+        p_pool->next_instance = 0u;
+        p_pool->busy = 0u;
+        p_pool->generation = 0u;
+        p_pool->b_stop = false;
+
+        pthread_mutex_init(&p_pool->lock, NULL);
+        pthread_cond_init(&p_pool->work_cv, NULL);
+        pthread_cond_init(&p_pool->done_cv, NULL);
+
+        b_result = true;
+
+        for(size_t idx = 0; b_result && (idx < thread_count); idx++)
+        {
+            b_result = (0 == pthread_create(&p_pool->threads[idx], NULL,
+                                            ws2812b_pool_worker, p_pool));
+            p_pool->thread_count += b_result ? 1u : 0u;
+        }
+
+        if(!b_result)
+        {
+            ws2812b_pool_deinit(p_pool);
+        }
+    }
+
+    return b_result;
+}
+
+/// Stop the workers and release the pool
+///
+/// @param p_pool        The pool to stop
+void ws2812b_pool_deinit(ws2812b_pool_t * const p_pool)
+{
+    if(NULL != p_pool)
+    {
+        pthread_mutex_lock(&p_pool->lock);
+        p_pool->b_stop = true;
+        pthread_cond_broadcast(&p_pool->work_cv);
+        pthread_mutex_unlock(&p_pool->lock);
+
+        for(size_t idx = 0; idx < p_pool->thread_count; idx++)
+        {
+            pthread_join(p_pool->threads[idx], NULL);
+        }
+
+        p_pool->thread_count = 0u;
+
+        pthread_cond_destroy(&p_pool->done_cv);
+        pthread_cond_destroy(&p_pool->work_cv);
+        pthread_mutex_destroy(&p_pool->lock);
+    }
+}
+
+/// Update the stream buffers of several strips in parallel
+///
+/// Does what the ws2812b_update_stream... function for each strip's clock
+/// would, encoding the dirty LEDs and clearing the dirty state, and
+/// returns once every strip is encoded.  One long strip can be passed on
+/// its own, it is split across the workers just the same.
+///
+/// In place strips (ws2812b_data_init_in_place) are skipped and left dirty,
+/// their storage overlaps the stream so they must go through
+/// ws2812b_update_stream.
+///
+/// @param p_pool          The pool to run on
+/// @param pp_instances    Array of initialized strips
+/// @param instance_count  The number of strips
+///
+/// @return TRUE on success, FALSE if a strip was skipped
+bool ws2812b_pool_update_streams(ws2812b_pool_t * const p_pool,
+                                 ws2812b_t * const * const pp_instances,
+                                 size_t const instance_count)
+{
+    bool b_result = false;
+
+    if((NULL != p_pool) && (NULL != pp_instances))
+    {
+        b_result = true;
+
+        for(size_t idx = 0; idx < instance_count; idx++)
+        {
+            if(NULL != pp_instances[idx])
+            {
+                b_result = b_result && !pp_instances[idx]->b_in_place;
+
+                // The dither changes every LED of a 16 bit strip every frame
+                if(NULL != pp_instances[idx]->p_buffer16)
+                {
+                    ws2812b_data_mark_dirty_all(pp_instances[idx]);
+                }
+            }
+        }
+
+        pthread_mutex_lock(&p_pool->lock);
+
+        p_pool->pp_instances = pp_instances;
+        p_pool->instance_count = instance_count;
+        p_pool->next_instance = 0u;
+        p_pool->next_span = 0u;
+        p_pool->next_led = 0u;
+        p_pool->generation++;
+
+        pthread_cond_broadcast(&p_pool->work_cv);
+        pthread_mutex_unlock(&p_pool->lock);
+
+        // Help out, then wait for the slices still in flight
+        ws2812b_pool_run(p_pool);
+
+        pthread_mutex_lock(&p_pool->lock);
+
+        while(0u < p_pool->busy)
+        {
+            pthread_cond_wait(&p_pool->done_cv, &p_pool->lock);
+        }
+
+        p_pool->pp_instances = NULL;
+        p_pool->instance_count = 0u;
+
+        pthread_mutex_unlock(&p_pool->lock);
+
+        for(size_t idx = 0; idx < instance_count; idx++)
+        {
+            if( (NULL != pp_instances[idx]) &&
+                (NULL != pp_instances[idx]->p_stream) &&
+                !pp_instances[idx]->b_in_place )
+            {
+                pp_instances[idx]->dirty_count = 0u;
+            }
+        }
+    }
+
+    return b_result;
+}
+
+/// Worker thread, runs every job until the pool is stopped
+///
+/// @param p_arg The pool
+///
+/// @return Always NULL
+static void * ws2812b_pool_worker(void * p_arg)
+{
+    ws2812b_pool_t * const p_pool = (ws2812b_pool_t *)p_arg;
+    uint32_t seen = 0u;
+
+    pthread_mutex_lock(&p_pool->lock);
+
+    while(!p_pool->b_stop)
+    {
+        if(seen != p_pool->generation)
+        {
+            seen = p_pool->generation;
+
+            pthread_mutex_unlock(&p_pool->lock);
+            ws2812b_pool_run(p_pool);
+            pthread_mutex_lock(&p_pool->lock);
+        }
+        else
+        {
+            pthread_cond_wait(&p_pool->work_cv, &p_pool->lock);
+        }
+    }
+
+    pthread_mutex_unlock(&p_pool->lock);
+
+    return NULL;
+}
+
+/// Take slices from the current job and encode them until it runs out
+///
+/// @param p_pool The pool
+static void ws2812b_pool_run(ws2812b_pool_t * const p_pool)
+{
+    bool b_more = true;
+
+    while(b_more)
+    {
+        ws2812b_t * p_instance = NULL;
+        size_t led_idx = 0u;
+        size_t led_cnt = 0u;
+
+        pthread_mutex_lock(&p_pool->lock);
+
+        // Advance the cursor to the next dirty LED
+        while((NULL == p_instance) && (p_pool->next_instance < p_pool->instance_count))
+        {
+            ws2812b_t * const p_candidate = p_pool->pp_instances[p_pool->next_instance];
+
+            if( (NULL != p_candidate) &&
+                (NULL != p_candidate->p_stream) &&
+                !p_candidate->b_in_place &&
+                (p_pool->next_span < p_candidate->dirty_count) )
+            {
+                ws2812b_span_t const * const p_span = &p_candidate->dirty[p_pool->next_span];
+                size_t const start = p_span->start + p_pool->next_led;
+
+                if(start < p_span->end)
+                {
+                    size_t const left = p_span->end - start;
+
+                    p_instance = p_candidate;
+                    led_idx = start;
+                    led_cnt = (left < p_pool->slice_leds) ? left : p_pool->slice_leds;
+                    p_pool->next_led += led_cnt;
+                }
+                else
+                {
+                    p_pool->next_span++;
+                    p_pool->next_led = 0u;
+                }
+            }
+            else
+            {
+                p_pool->next_instance++;
+                p_pool->next_span = 0u;
+                p_pool->next_led = 0u;
+            }
+        }
+
+        b_more = (NULL != p_instance);
+        p_pool->busy += b_more ? 1u : 0u;
+
+        pthread_mutex_unlock(&p_pool->lock);
+
+        if(b_more)
+        {
+            size_t const bytes_per_led = ws2812b_data_stream_bytes_per_led(p_instance);
+
+            if(NULL != p_instance->p_buffer16)
+            {
+                (void)ws2812b_data_dither(p_instance, led_idx + 1u, led_cnt);
+            }
+
+            (void)ws2812b_data_encode(p_instance,
+                                      &p_instance->p_stream[led_idx * bytes_per_led],
+                                      led_idx + 1u,
+                                      led_cnt);
+
+            pthread_mutex_lock(&p_pool->lock);
+
+            p_pool->busy--;
+
+            if(0u == p_pool->busy)
+            {
+                pthread_cond_broadcast(&p_pool->done_cv);
+            }
+
+            pthread_mutex_unlock(&p_pool->lock);
+        }
+    }
+}
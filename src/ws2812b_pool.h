@@ -0,0 +1,51 @@
+/// ws2812b_pool
+///
+/// This module spreads stream encoding of long strips, or of many strips,
+/// across a fixed pool of worker threads (POSIX threads, host builds only)
+
+#ifndef WS2812B_POOL_H_
+#define WS2812B_POOL_H_
+
+#include "ws2812b_data.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+
+/// Most worker threads a pool can start
+#define WS2812B_POOL_THREADS_MAX 64u
+/// Default LEDs per slice, big enough to hide the hand off cost
+#define WS2812B_POOL_SLICE_LEDS 4096u
+
+/// This struct holds a pool of encode workers and the job they share
+typedef struct
+{
+    pthread_t           threads[WS2812B_POOL_THREADS_MAX]; ///< Worker threads
+    size_t              thread_count;   ///< The number of worker threads started
+    size_t              slice_leds;     ///< Most LEDs encoded per slice
+    pthread_mutex_t     lock;           ///< Guards everything below
+    pthread_cond_t      work_cv;        ///< Signals a new job or shutdown
+    pthread_cond_t      done_cv;        ///< Signals the job finished
+    ws2812b_t * const * pp_instances;   ///< Strips of the current job
+    size_t              instance_count; ///< The number of strips in the job
+    size_t              next_instance;  ///< Job cursor, strip
+    size_t              next_span;      ///< Job cursor, dirty span of the strip
+    size_t              next_led;       ///< Job cursor, LED index in the span
+    size_t              busy;           ///< Slices being encoded
+    uint32_t            generation;     ///< Bumped for every job
+    bool                b_stop;         ///< Workers exit when set
+}
+ws2812b_pool_t;
+
+
+bool ws2812b_pool_init(ws2812b_pool_t * const p_pool,
+                       size_t const thread_count,
+                       size_t const slice_leds);
+void ws2812b_pool_deinit(ws2812b_pool_t * const p_pool);
+bool ws2812b_pool_update_streams(ws2812b_pool_t * const p_pool,
+                                 ws2812b_t * const * const pp_instances,
+                                 size_t const instance_count);
+
+#endif /* WS2812B_POOL_H_ */